@@ -1,6 +1,12 @@
 #include "CMRMR.hpp"
+#include "CMappedFile.hpp"
+#include "CMRMRStats.hpp"
+#include "CSocket.hpp"
+#include "CThreadPool.hpp"
+#include "MutualInfo.hpp"
 
 #include <cstdlib>
+#include <cstdio>
 #include <cmath>
 #include <map>
 #include <numeric>
@@ -8,20 +14,194 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <cstdint>
+#include <atomic>
+#include <charconv>
+#include <system_error>
+#include <cstring>
+#include <memory>
 
 using namespace std;
+
+///-------------------- CSV Parsing --------------------
+namespace
+{
+///-------------------------------------------------------------------------------------------------
+/// <summary> Skip spaces, tabulations and carriage returns. </summary>
+inline const char* skipBlanks(const char* p, const char* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) { ++p; }
+	return p;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Parse a number without locale. </summary>
+/// <returns> The pointer after the number or nullptr if fail. </returns>
+template <typename T>
+const char* parseNumber(const char* p, const char* end, T& value)
+{
+	p = skipBlanks(p, end);
+	if (p < end && *p == '+') { ++p; }
+#if defined(__cpp_lib_to_chars) || defined(_MSC_VER)
+	const auto res = from_chars(p, end, value);
+	return (res.ec == errc()) ? res.ptr : nullptr;
+#else
+	// Without floating point from_chars, the token is copied to be null terminated for strtod
+	char buffer[64];
+	const size_t n = size_t(find_if(p, end, [](const char c) { return c == ',' || c == '\n' || c == '\r' || c == ' ' || c == '\t'; }) - p);
+	if (n == 0 || n >= sizeof(buffer)) { return nullptr; }
+	copy(p, p + n, buffer);
+	buffer[n] = '\0';
+	char* last;
+	value = T(strtod(buffer, &last));
+	return (last == buffer + n) ? p + n : nullptr;
+#endif
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Parse a line of the CSV file in the column major matrix (double or float, the values are parsed in double). </summary>
+/// <returns> The number of features correctly read (stop at the first bad value). </returns>
+template <typename T>
+size_t parseLine(const char* p, const char* end, const size_t nFeatures, int& classId, T* datas, const size_t stride)
+{
+	p = parseNumber(p, end, classId);
+	if (p == nullptr) { return 0; }
+	for (size_t j = 0; j < nFeatures; ++j)
+	{
+		p = skipBlanks(p, end);
+		if (p == end || *p != ',') { return j; }
+		double value;
+		p = parseNumber(p + 1, end, value);
+		if (p == nullptr) { return j; }
+		datas[j * stride] = T(value);
+	}
+	return nFeatures;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Check and parse a line of the CSV file in the column major matrix. </summary>
+/// <returns> The error message (empty if success). </returns>
+template <typename T>
+string readLine(const char* p, const char* eol, const size_t nFeatures, int& classId, T* datas, const size_t stride)
+{
+	const size_t n = size_t(std::count(p, eol, ','));
+	stringstream error;
+	if (n != nFeatures) { error << "not same number of features : " << n << "expected : " << nFeatures; }
+	else
+	{
+		const size_t parsed = parseLine(p, eol, nFeatures, classId, datas, stride);
+		if (parsed != nFeatures) { error << "not found good number of features : " << parsed << "expected : " << nFeatures; }
+	}
+	return error.str();
+}
+///-------------------------------------------------------------------------------------------------
+}	// namespace
+
+///-------------------- Sharded selection --------------------
+namespace
+{
+/// <summary> Messages of the coordinator to a worker (see CMRMR::processSharded). </summary>
+/// - Start : encode the features and send the informations of the shard and its best candidate by relevance.
+/// - Select : a feature is selected, send its column if it's in the shard (otherwise the column follows), then send the best candidate.
+/// - Stop : end of the session.
+enum class EShardMessage : uint32_t { Start, Select, Stop };
+
+/// <summary> Parameters of a selection. </summary>
+struct SShardStart
+{
+	double threshold;	// The threshold for discretization
+	uint64_t method;	// Method Used for mRMR
+};
+
+/// <summary> Informations of a shard. </summary>
+struct SShardInfo
+{
+	uint64_t ok;		// The features are encoded
+	uint64_t nFeatures;	// Number of features of the shard
+	uint64_t nSamples;	// Number of samples
+};
+
+/// <summary> Best candidate of a shard. </summary>
+struct SShardBest
+{
+	uint64_t found;		// A candidate beats the initial score
+	uint64_t feature;	// Feature in the shard
+	double score;		// Score of the candidate (relevance for the first feature)
+	double relevance;	// Relevance of the candidate
+};
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Send a value (or a message type and its value). </summary>
+template <typename T>
+bool sendValue(const CSocket& socket, const T& value) { return socket.send(&value, sizeof(T)); }
+
+template <typename T>
+bool sendValue(const CSocket& socket, const EShardMessage type, const T& value) { return sendValue(socket, type) && sendValue(socket, value); }
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Receive a value. </summary>
+template <typename T>
+bool receiveValue(const CSocket& socket, T& value) { return socket.receive(&value, sizeof(T)); }
+///-------------------------------------------------------------------------------------------------
+}	// namespace
+
+///-------------------- Mutual infos --------------------
+namespace
+{
+///-------------------------------------------------------------------------------------------------
+/// <summary> Workspace of the mutual infos of the calling thread. </summary>
+/// The buffers are kept between the calls (and the rounds of the selection), so a mutual info doesn't allocate once they are big enough.
+MutualInfo::SWorkspace& workspace()
+{
+	thread_local MutualInfo::SWorkspace ws;
+	return ws;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Add bytes to a hash (FNV-1a by 64 bits words with a shift to mix the high bits). </summary>
+uint64_t hashBytes(uint64_t hash, const void* data, const size_t size)
+{
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	size_t i          = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof(uint64_t));
+		hash = (hash ^ word) * 0x100000001B3ULL;
+		hash ^= hash >> 29;
+	}
+	for (; i < size; ++i) { hash = (hash ^ bytes[i]) * 0x100000001B3ULL; }
+	return hash;
+}
+///-------------------------------------------------------------------------------------------------
+}	// namespace
+
 ///-------------------- Public Functions --------------------
 ///-------------------------------------------------------------------------------------------------
 void CMRMR::reset()
 {
 	m_nFeatures = 0;
 	m_nSamples  = 0;
+	m_stride    = 0;
 	//if (!m_classes.empty()) { for (auto& c : m_classes) { c.second.clear(); } }	// useless
-	//if (!m_datas.empty()) { for (auto& d : m_datas) { d.clear(); } }				// useless
-	//if (!m_discretized.empty()) { for (auto& d : m_discretized) { d.clear(); } }	// useless
+	//if (!m_codes.empty()) { m_codes.clear(); }										// useless
 	m_classes.clear();
 	m_datas.clear();
-	m_discretized.clear();
+	m_floatDatas.clear();
+	m_stats.clear();
+	m_sparseOffsets.clear();
+	m_sparseRows.clear();
+	m_sparseValues.clear();
+	m_classCodes.clear();
+	m_classCounts.clear();
+	m_mappedDatas = nullptr;
+	m_infos       = SInfosMatrix();
+	invalidateCodes();
 }
 ///-------------------------------------------------------------------------------------------------
 
@@ -37,70 +217,289 @@ string CMRMR::print() const
 		ss << "Class " << i++ << " : " << "id(" << it.first << "), " << it.second.size() << " samples";
 	}
 	ss << ")." << endl;
-	ss << "Datas are " << (m_discretized.empty() ? "not " : "") << "z-scored and discretize." << endl;
+	ss << "Datas are " << (hasCodes() ? "" : "not ") << "z-scored and discretize." << endl;
 	return ss.str();
 }
 ///-------------------------------------------------------------------------------------------------
 
 ///-------------------------------------------------------------------------------------------------
-bool CMRMR::readCSV(const std::string& filename)
+bool CMRMR::readCSV(const std::string& filename, const size_t nThreads)
 {
 	reset();
-	ifstream file;
-	file.open(filename);
-	if (!file.is_open())
+	CPhaseTimer timer(m_runStats, EPhase::Read);
+	CMappedFile file;
+	if (!file.open(filename))
 	{
 		cerr << "File cannot be opened." << endl;
 		return false;
 	}
+	if (file.size() == 0)
+	{
+		cerr << "Header can not be read." << endl;
+		return false;
+	}
+
+	const char* begin = file.data();
+	const char* end   = begin + file.size();
+	const char* body  = find(begin, end, '\n');
+	m_nFeatures       = size_t(std::count(begin, body, ','));
+	if (body != end) { ++body; }
+
+	// Line aligned chunks
+	CThreadPool pool(nThreads);
+	const size_t nChunks = min(size_t(end - body) / 4096 + 1, 8 * pool.size());
+	vector<const char*> bounds(nChunks + 1, end);
+	bounds[0] = body;
+	for (size_t c = 1; c < nChunks; ++c)
+	{
+		const char* p = max(bounds[c - 1], body + size_t(end - body) * c / nChunks);
+		p             = find(p, end, '\n');
+		bounds[c]     = (p == end) ? end : p + 1;
+	}
+
+	// First pass : number of lines by chunk (the last line can be without end of line)
+	vector<size_t> offsets(nChunks + 1, 0);
+	pool.parallelFor(nChunks, [&](const size_t first, const size_t last)
+	{
+		for (size_t c = first; c < last; ++c)
+		{
+			offsets[c + 1] = size_t(std::count(bounds[c], bounds[c + 1], '\n'));
+			if (bounds[c + 1] == end && bounds[c] != end && *(end - 1) != '\n') { offsets[c + 1]++; }
+		}
+	});
+	partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+	const size_t nSamples = offsets[nChunks];
+
+	// Second pass : parse directly in the column major matrix, each chunk keeps its first error
+	m_stride = nSamples;
+	resizeDatas(m_nFeatures * nSamples);
+	vector<int> classIds(nSamples);
+	vector<size_t> errorLines(nChunks, size_t(-1));
+	vector<string> errors(nChunks);
+	pool.parallelFor(nChunks, [&](const size_t first, const size_t last)
+	{
+		for (size_t c = first; c < last; ++c)
+		{
+			size_t row = offsets[c];
+			for (const char* p = bounds[c]; p < bounds[c + 1]; ++row)
+			{
+				const char* eol = find(p, bounds[c + 1], '\n');
+				errors[c]       = isFloat() ? readLine(p, eol, m_nFeatures, classIds[row], m_floatDatas.data() + row, m_stride)
+										  : readLine(p, eol, m_nFeatures, classIds[row], m_datas.data() + row, m_stride);
+				if (!errors[c].empty())
+				{
+					errorLines[c] = row;
+					break;
+				}
+				p = (eol == bounds[c + 1]) ? eol : eol + 1;
+			}
+		}
+	});
+
+	// The reported error is the first in the file
+	const auto firstError = min_element(errorLines.begin(), errorLines.end());
+	if (*firstError != size_t(-1))
+	{
+		cerr << errors[size_t(firstError - errorLines.begin())] << endl;
+		reset();
+		return false;
+	}
+
+	// Update class list
+	for (size_t i = 0; i < nSamples; ++i) { m_classes[classIds[i]].push_back(i); }
+	m_nSamples = nSamples;
+	updateWorkingSet();
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
 
-	string header;
-	if (!getline(file, header))
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::streamCSV(const std::string& filename, const double threshold, const std::string& scratch, const size_t nThreads)
+{
+	reset();
+	if (std::isinf(threshold) && m_binning == EBinning::EqualFrequency)
+	{
+		cerr << "EqualFrequency binning needs all the values of a feature, it can't be used in streaming mode." << endl;
+		return false;
+	}
+	CMappedFile file;
+	if (!file.open(filename))
+	{
+		cerr << "File cannot be opened." << endl;
+		return false;
+	}
+	if (file.size() == 0)
 	{
 		cerr << "Header can not be read." << endl;
 		return false;
 	}
 
-	m_nFeatures = std::count(header.begin(), header.end(), ',');
-	m_nSamples  = 0;
+	const char* begin = file.data();
+	const char* end   = begin + file.size();
+	const char* body  = find(begin, end, '\n');
+	m_nFeatures       = size_t(std::count(begin, body, ','));
+	if (body != end) { ++body; }
+
+	// Begin of each line (the last element is the end of file)
+	vector<const char*> lines;
+	for (const char* p = body; p < end;)
+	{
+		lines.push_back(p);
+		const char* eol = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+		p               = (eol == nullptr) ? end : eol + 1;
+	}
+	const size_t nSamples = lines.size();
+	lines.push_back(end);
 
-	string line;
-	while (getline(file, line))
+	// Parse a block of lines in a column major buffer (the reported error is the first in the file)
+	CThreadPool pool(nThreads);
+	const size_t blockSize = max(size_t(1), min(nSamples, STREAM_BLOCK / (sizeof(double) * max(size_t(1), m_nFeatures))));
+	vector<double> block(m_nFeatures * blockSize);
+	vector<int> classIds(nSamples);
+	const auto parseBlock = [&](const size_t first, const size_t count)
 	{
-		if (std::count(line.begin(), line.end(), ',') != m_nFeatures)
+		vector<string> errors(count);
+		pool.parallelFor(count, [&](const size_t b, const size_t e)
+		{
+			for (size_t r = b; r < e; ++r)
+			{
+				const char* eol = find(lines[first + r], lines[first + r + 1], '\n');
+				errors[r]       = readLine(lines[first + r], eol, m_nFeatures, classIds[first + r], block.data() + r, blockSize);
+			}
+		});
+		for (const auto& error : errors)
 		{
-			cerr << "not same number of features : " << std::count(line.begin(), line.end(), ',') << "expected : " << m_nFeatures << endl;
+			if (error.empty()) { continue; }
+			cerr << error << endl;
 			return false;
 		}
-		std::vector<double> sample;
-		sample.reserve(m_nFeatures);
-		int classId;
-		double value;
-		char sep;
-		stringstream ss(line);
-		ss >> classId;
-		while (ss >> sep >> value) { sample.push_back(value); }
-		if (sample.size() != m_nFeatures)
+		return true;
+	};
+
+	// First pass : statistics of each feature
+	CPhaseTimer readTimer(m_runStats, EPhase::Read);
+	vector<SFeatureStats> stats(m_nFeatures);
+	for (size_t first = 0; first < nSamples; first += blockSize)
+	{
+		const size_t count = min(blockSize, nSamples - first);
+		if (!parseBlock(first, count))
 		{
-			cerr << "not found good number of features : " << sample.size() << "expected : " << m_nFeatures << endl;
+			reset();
 			return false;
 		}
-		m_datas.push_back(std::move(sample));
+		pool.parallelFor(m_nFeatures, [&](const size_t b, const size_t e)
+		{
+			for (size_t j = b; j < e; ++j) { for (size_t r = 0; r < count; ++r) { stats[j].update(block[j * blockSize + r]); } }
+		});
+	}
+	for (size_t i = 0; i < nSamples; ++i) { m_classes[classIds[i]].push_back(i); }
+	m_nSamples = nSamples;
+	m_stride   = nSamples;
+	if (m_nFeatures == 0 || m_nSamples == 0) { return true; }
+
+	// States of each feature
+	vector<int> mins(m_nFeatures);
+	vector<SEncoder> encoders(m_nFeatures);
+	m_nStates.assign(m_nFeatures, 0);
+	m_ignored.assign(m_nFeatures, 0);
+	for (size_t j = 0; j < m_nFeatures; ++j)
+	{
+		encoders[j] = encoder(stats[j], threshold);
+		statesRange(j, stats[j], encoders[j], mins[j], m_nStates[j]);
+		m_ignored[j] = encoders[j].single ? 1 : 0;
+	}
 
-		// Update class list
-		auto it = m_classes.find(classId);
-		if (it == m_classes.end())
+	// Second pass : codes of each feature in the scratch file
+	readTimer.stop();
+	CPhaseTimer encodeTimer(m_runStats, EPhase::Encode);
+	shared_ptr<CMappedFile> codes = make_shared<CMappedFile>();
+	if (!codes->create(scratch, m_nFeatures * m_nSamples * sizeof(code_t)))
+	{
+		cerr << "Scratch file cannot be created." << endl;
+		reset();
+		return false;
+	}
+	code_t* out = reinterpret_cast<code_t*>(codes->writableData());
+	for (size_t first = 0; first < nSamples; first += blockSize)
+	{
+		const size_t count = min(blockSize, nSamples - first);
+		parseBlock(first, count);	// Already checked by the first pass
+		pool.parallelFor(m_nFeatures, [&](const size_t b, const size_t e)
 		{
-			m_classes.emplace(classId, vector<size_t>());
-			it = m_classes.find(classId);
-		}
-		it->second.push_back(m_nSamples++);
+			for (size_t j = b; j < e; ++j)
+			{
+				code_t* column = out + j * m_nSamples + first;
+				for (size_t r = 0; r < count; ++r) { column[r] = code_t(encoders[j].state(block[j * blockSize + r]) - mins[j]); }
+			}
+		});
 	}
+	m_file           = codes;
+	m_mappedCodes    = out;
+	m_codesThreshold = threshold;
+	m_codesBinning   = m_binning;
+	m_codesBins      = m_nBins;
+	m_nEncoded       = m_nSamples;
+	updateWorkingSet();
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::setStats(CMRMRStats* stats) { m_runStats = stats; }
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::setPruning(const bool pruning) { m_pruning = pruning; }
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::setCandidatePool(const size_t size, const size_t prescreen)
+{
+	m_poolSize  = size;
+	m_prescreen = prescreen;
+}
+///-------------------------------------------------------------------------------------------------
 
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::setBinning(const EBinning binning, const size_t nBins)
+{
+	if (binning != EBinning::Round && (nBins == 0 || nBins > size_t(numeric_limits<code_t>::max()) + 1))
+	{
+		cerr << "Bad number of bins : " << nBins << " (1 to " << size_t(numeric_limits<code_t>::max()) + 1 << ")" << endl;
+		return false;
+	}
+	m_binning = binning;
+	m_nBins   = nBins;
 	return true;
 }
 ///-------------------------------------------------------------------------------------------------
 
+///-------------------------------------------------------------------------------------------------
+void CMRMR::setPrecision(const EPrecision precision)
+{
+	if (precision == m_precision) { return; }
+	if (m_mappedDatas == nullptr && hasRawDatas())	// The owned datas are converted (a mapped file is kept in double)
+	{
+		convertDatas(m_stride, precision);
+		if (precision == EPrecision::Float) { invalidateCodes(); }	// The values are rounded
+	}
+	m_precision = precision;
+	updateWorkingSet();
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::setReleaseDatas(const bool release) { m_releaseDatas = release; }
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::setIncremental(const bool incremental)
+{
+	m_incremental = incremental;
+	if (!m_incremental) { m_tables.clear(); }
+}
+///-------------------------------------------------------------------------------------------------
+
 ///-------------------------------------------------------------------------------------------------
 bool CMRMR::setDatas(const std::vector<std::vector<double>>& datas, const std::vector<int>& classes)
 {
@@ -118,6 +517,12 @@ bool CMRMR::addDatas(const std::vector<std::vector<double>>& datas, const std::v
 		cerr << "not same number of sample between datas and classes : " << n << " VS " << classes.size() << endl;;
 		return false;
 	}
+	if (isSparse())
+	{
+		cerr << "Samples can't be added to sparse datas." << endl;
+		return false;
+	}
+	reserve(m_nSamples + n);
 	for (size_t i = 0; i < n; ++i) { if (!addSample(datas[i], classes[i])) { return false; } }
 	return true;
 }
@@ -126,15 +531,37 @@ bool CMRMR::addDatas(const std::vector<std::vector<double>>& datas, const std::v
 ///-------------------------------------------------------------------------------------------------
 bool CMRMR::addSample(const std::vector<double>& sample, const int classId)
 {
-	if (m_nSamples == 0) { m_nFeatures = sample.size(); }
+	if (isSparse())
+	{
+		cerr << "Samples can't be added to sparse datas." << endl;
+		return false;
+	}
+	if (m_nSamples == 0)
+	{
+		m_nFeatures = sample.size();
+		resizeDatas(m_nFeatures * m_stride);	// The stride can be reserved before the number of features is known
+	}
 	else if (m_nFeatures != sample.size())
 	{
 		cerr << "not same number of features between sample and previous samples : " << sample.size() << " VS " << m_nFeatures << endl;;
 		return false;
 	}
+	else if (!hasRawDatas())
+	{
+		cerr << "Raw datas are not available (streaming mode or released)." << endl;
+		return false;
+	}
 
-	// Update datas
-	m_datas.push_back(sample);
+	// Update datas (the codes are updated by the next process), the statistics use the stored values
+	if (m_nSamples == m_stride) { reserve(max(size_t(1), 2 * m_stride)); }
+	const bool single = isFloat();
+	for (size_t j = 0; j < m_nFeatures; ++j)
+	{
+		const double value = single ? double(float(sample[j])) : sample[j];
+		if (single) { m_floatDatas[j * m_stride + m_nSamples] = float(value); }
+		else { m_datas[j * m_stride + m_nSamples] = value; }
+		if (m_stats.size() == m_nFeatures) { m_stats[j].update(value); }
+	}
 
 	// Update class list
 	auto it = m_classes.find(classId);
@@ -149,187 +576,1829 @@ bool CMRMR::addSample(const std::vector<double>& sample, const int classId)
 ///-------------------------------------------------------------------------------------------------
 
 ///-------------------------------------------------------------------------------------------------
-vector<size_t> CMRMR::process(const double threshold, const size_t nFeatures, const EMRMRMethod method)
+bool CMRMR::addFeatures(const std::vector<std::vector<double>>& columns)
 {
-	if (m_nSamples == 0 || m_nFeatures == 0) { return vector<size_t>(); }
-	m_discretized.reserve(m_nSamples);
-	for (auto&& v : m_datas) { m_discretized.emplace_back(std::begin(v), std::end(v)); }
+	if (m_nSamples == 0 || isSparse())
+	{
+		cerr << "Features can only be appended to dense datas with samples." << endl;
+		return false;
+	}
+	if (!hasRawDatas())
+	{
+		cerr << "Raw datas are not available (streaming mode or released)." << endl;
+		return false;
+	}
+	for (const auto& c : columns)
+	{
+		if (c.size() != m_nSamples)
+		{
+			cerr << "not same number of samples between the new feature and previous datas : " << c.size() << " VS " << m_nSamples << endl;
+			return false;
+		}
+	}
+	if (m_mappedDatas != nullptr) { convertDatas(m_stride, m_precision); }	// The columns of a mapped file are copied once
 
-	if (threshold != numeric_limits<double>::infinity())
+	// The new columns are stored after the others (same stride), the statistics are kept up to date if they are
+	const size_t first = m_nFeatures;
+	const bool withStats = m_stats.size() == m_nFeatures;
+	m_nFeatures += columns.size();
+	resizeDatas(m_nFeatures * m_stride);
+	const bool single = isFloat();
+	for (size_t j = first; j < m_nFeatures; ++j)
 	{
-		m_discretized.resize(m_nSamples);
-		for (auto& d : m_discretized) { d.resize(m_nFeatures); }
-		zScore();						// Compute zScore
-		if (threshold != numeric_limits<double>::infinity()) { discretize(threshold); }	// Compute discretization
+		SFeatureStats stats;
+		for (size_t i = 0; i < m_nSamples; ++i)
+		{
+			const double value = single ? double(float(columns[j - first][i])) : columns[j - first][i];
+			if (single) { m_floatDatas[j * m_stride + i] = float(value); }
+			else { m_datas[j * m_stride + i] = value; }
+			stats.update(value);
+		}
+		if (withStats) { m_stats.push_back(stats); }
 	}
-	return mRMR(nFeatures, method);	// Apply mRMR Algorithm
+	return true;
 }
 ///-------------------------------------------------------------------------------------------------
 
-///-------------------- Private Functions --------------------
 ///-------------------------------------------------------------------------------------------------
-std::vector<int> CMRMR::class2IdxVector(size_t& n) const
+bool CMRMR::setSparseDatas(const ESparseFormat format, const size_t nFeatures, const std::vector<size_t>& offsets, const std::vector<size_t>& indexes,
+						   const std::vector<double>& values, const std::vector<int>& classes)
 {
-	vector<int> res;
-	res.resize(m_nSamples);				// Features from all samples
-	int min = numeric_limits<int>::max();
-	int max = numeric_limits<int>::min();
+	reset();
+	const size_t nSamples = classes.size();
+	const size_t nGroups  = (format == ESparseFormat::CSR) ? nSamples : nFeatures;	// Samples (CSR) or features (CSC)
+	const size_t nIndexes = (format == ESparseFormat::CSR) ? nFeatures : nSamples;	// Range of the indexes
+	if (offsets.size() != nGroups + 1 || offsets.front() != 0 || offsets.back() != indexes.size() || indexes.size() != values.size()
+		|| !is_sorted(offsets.begin(), offsets.end()))
+	{
+		cerr << "not valid sparse datas : " << offsets.size() << " offsets, " << indexes.size() << " indexes, " << values.size() << " values for " << nSamples
+				<< " samples and " << nFeatures << " features" << endl;
+		return false;
+	}
+	if (nSamples > size_t(numeric_limits<uint32_t>::max()))
+	{
+		cerr << "too many samples for sparse datas : " << nSamples << endl;
+		return false;
+	}
+	for (size_t g = 0; g < nGroups; ++g)
+	{
+		for (size_t k = offsets[g]; k < offsets[g + 1]; ++k)
+		{
+			if (indexes[k] >= nIndexes || (k > offsets[g] && indexes[k] <= indexes[k - 1]))
+			{
+				cerr << "not valid sparse index " << indexes[k] << " at position " << k << " (indexes must be sorted and lower than " << nIndexes << ")" << endl;
+				return false;
+			}
+		}
+	}
 
-	for (const auto& m : m_classes)
+	// Values by feature (a CSR matrix is transposed with a counting sort, the samples stay sorted)
+	m_nFeatures = nFeatures;
+	m_nSamples  = nSamples;
+	m_stride    = nSamples;
+	if (format == ESparseFormat::CSC)
 	{
-		const int tmp = m.first;
-		if (min > tmp) { min = tmp; }
-		if (max < tmp) { max = tmp; }
-		for (const auto& sampleIdx : m.second) { res[sampleIdx] = tmp; }
+		m_sparseOffsets = offsets;
+		m_sparseRows.assign(indexes.begin(), indexes.end());
+		m_sparseValues = values;
 	}
-	for (auto& v : res) { v -= min; }	// transform to 0 to n Indexes
-	n = size_t(max - min + 1);
-	return res;
+	else
+	{
+		m_sparseOffsets.assign(nFeatures + 1, 0);
+		for (const auto& j : indexes) { m_sparseOffsets[j + 1]++; }
+		partial_sum(m_sparseOffsets.begin(), m_sparseOffsets.end(), m_sparseOffsets.begin());
+		vector<size_t> next(m_sparseOffsets.begin(), m_sparseOffsets.end() - 1);
+		m_sparseRows.resize(indexes.size());
+		m_sparseValues.resize(values.size());
+		for (size_t i = 0; i < nSamples; ++i)
+		{
+			for (size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+			{
+				const size_t pos    = next[indexes[k]]++;
+				m_sparseRows[pos]   = uint32_t(i);
+				m_sparseValues[pos] = values[k];
+			}
+		}
+	}
+
+	// Class list
+	for (size_t i = 0; i < nSamples; ++i) { m_classes[classes[i]].push_back(i); }
+	return true;
 }
 ///-------------------------------------------------------------------------------------------------
 
 ///-------------------------------------------------------------------------------------------------
-std::vector<int> CMRMR::discret2IdxVector(const size_t feature, size_t& n) const
+vector<size_t> CMRMR::process(const double threshold, const size_t nFeatures, const EMRMRMethod method, const size_t nThreads)
 {
-	vector<int> res;
-	res.reserve(m_nSamples);				// Features from all samples
-	int min = m_discretized[0][feature];
-	int max = m_discretized[0][feature];
-	for (const auto& d : m_discretized)
-	{
-		const int tmp = int(round(d[feature]));
-		res.push_back(tmp);
-		if (min > tmp) { min = tmp; }
-		if (max < tmp) { max = tmp; }
-	}
-	for (auto& id : res) { id -= min; }	// transform to 0 to n Indexes
-	n = size_t(max - min + 1);
-	return res;
+	if (m_nSamples == 0 || m_nFeatures == 0) { return vector<size_t>(); }
+	CThreadPool pool(nThreads);
+	if (!prepare(threshold, pool)) { return vector<size_t>(); }
+	return mRMR(nFeatures, method, pool);	// Apply mRMR Algorithm
 }
 ///-------------------------------------------------------------------------------------------------
 
 ///-------------------------------------------------------------------------------------------------
-void CMRMR::zScore()
+vector<size_t> CMRMR::processProgressive(const SProgress& progress, const double threshold, const size_t nFeatures, const EMRMRMethod method, const size_t nThreads)
 {
-	// We z-score by feature (so column by column)
-	for (size_t j = 0; j < m_nFeatures; ++j)
-	{
-		double sum = 0.0;
-		for (const auto& d : m_datas) { sum += d[j]; }
-		const double mean = sum / double(m_nSamples);
-		sum               = 0.0;
-		for (const auto& d : m_datas)
-		{
-			const double tmp = d[j] - mean;
-			sum += tmp * tmp;
-		}
-		const double std = (m_nSamples == 1) ? 0 : sqrt(sum / double(m_nSamples - 1));	//m_nSamples - 1 is an unbiased version for Gaussian
-		for (size_t i = 0; i < m_nSamples; ++i) { m_discretized[i][j] = (m_datas[i][j] - mean) / std; }
-	}
+	const auto start = chrono::steady_clock::now();	// The budget includes the encoding
+	if (m_nSamples == 0 || m_nFeatures == 0) { return vector<size_t>(); }
+	CThreadPool pool(nThreads);
+	if (!prepare(threshold, pool)) { return vector<size_t>(); }
+	return mRMR(nFeatures, method, pool, nullptr, &progress, start);
 }
 ///-------------------------------------------------------------------------------------------------
 
 ///-------------------------------------------------------------------------------------------------
-void CMRMR::discretize(const double threshold)
+vector<vector<size_t>> CMRMR::processBatch(const vector<SProcessConfig>& configs, const size_t nThreads)
 {
-	for (auto& sample : m_discretized)
+	vector<vector<size_t>> res(configs.size());
+	if (m_nSamples == 0 || m_nFeatures == 0) { return res; }
+	CThreadPool pool(nThreads);
+	const bool incremental = m_incremental;
+	m_incremental          = true;	// The joint counts are shared by the configurations of a threshold
+
+	vector<bool> done(configs.size(), false);
+	for (size_t c = 0; c < configs.size(); ++c)
 	{
-		for (auto& feature : sample)
+		if (done[c]) { continue; }
+		const double threshold = configs[c].threshold;
+		const bool encoded     = prepare(threshold, pool);	// Once by threshold (the codes are kept until the next threshold)
+		for (const EMRMRMethod method : { EMRMRMethod::MID, EMRMRMethod::MIQ })
 		{
-			if (feature > threshold) { feature = 1; }
-			else if (feature < -threshold) { feature = -1; }
-			else { feature = 0; }
+			// Biggest selection of this threshold and method, the others are its prefixes
+			size_t nFeatures = 0;
+			vector<size_t> same;
+			for (size_t d = c; d < configs.size(); ++d)
+			{
+				if (!done[d] && configs[d].threshold == threshold && configs[d].method == method)
+				{
+					same.push_back(d);
+					nFeatures = max(nFeatures, configs[d].nFeatures);
+				}
+			}
+			if (same.empty()) { continue; }
+			const vector<size_t> selection = encoded ? mRMR(nFeatures, method, pool) : vector<size_t>();
+			for (const auto& d : same)
+			{
+				res[d].assign(selection.begin(), selection.begin() + min(configs[d].nFeatures, selection.size()));
+				done[d] = true;
+			}
 		}
 	}
+
+	m_incremental = incremental;
+	if (!m_incremental) { m_tables.clear(); }
+	return res;
 }
 ///-------------------------------------------------------------------------------------------------
 
 ///-------------------------------------------------------------------------------------------------
-double CMRMR::mutualInfo(const size_t feature1, const size_t feature2) const
+CMRMR::SStability CMRMR::stability(const vector<vector<size_t>>& subsets, const double threshold, const size_t nFeatures, const EMRMRMethod method, const size_t nThreads)
 {
-	if ((feature1 != size_t(-1) && feature1 >= m_nFeatures) || (feature2 != size_t(-1) && feature2 >= m_nFeatures)) { return -1; }
-
-	// Copy Datas in int vector of size n_sample
-	size_t nstate1, nstate2;
-	vector<int> v1 = (feature1 != size_t(-1)) ? discret2IdxVector(feature1, nstate1) : class2IdxVector(nstate1);
-	vector<int> v2 = (feature2 != size_t(-1)) ? discret2IdxVector(feature2, nstate2) : class2IdxVector(nstate2);
-
-	// Joint Probabilities
-	vector<vector<double>> jointProba(nstate1, vector<double>(nstate2, 0.0));
-	for (size_t i = 0; i < m_nSamples; ++i) { jointProba[v1[i]][v2[i]]++; }
-	for (auto& row : jointProba) { for (auto& cell : row) { cell /= m_nSamples; } }
-
-	// Mutual Information
-	vector<double> proba1(nstate1, 0.0), proba2(nstate2, 0.0);
-	for (size_t i = 0; i < nstate1; ++i)
+	SStability res;
+	if (m_nSamples == 0 || m_nFeatures == 0) { return res; }
+	if (isSparse())
 	{
-		for (size_t j = 0; j < nstate2; ++j)
+		cerr << "Stability selection can't be used with sparse datas." << endl;
+		return res;
+	}
+	for (const auto& subset : subsets)
+	{
+		for (const auto& i : subset)
 		{
-			proba1[i] += jointProba[i][j];
-			proba2[j] += jointProba[i][j];
+			if (i >= m_nSamples)
+			{
+				cerr << "Sample " << i << " not in datas : " << m_nSamples << " samples" << endl;
+				return res;
+			}
 		}
 	}
+	CThreadPool pool(nThreads);
+	if (!prepare(threshold, pool)) { return res; }
 
-	double res = 0.0;
-	for (size_t i = 0; i < nstate1; ++i)
+	// Each subset is selected by one thread on the shared codes
+	// The rounds without a candidate beating the initial score are padded with the feature 0 as process, they are not counted in the frequencies
+	res.selections.resize(subsets.size());
+	vector<vector<size_t>> selected(subsets.size());	// Selected features of each subset without the padding
+	pool.parallelFor(subsets.size(), [&](const size_t begin, const size_t end)
 	{
-		for (size_t j = 0; j < nstate2; ++j)
+		CThreadPool sequential(1);
+		for (size_t s = begin; s < end; ++s)
 		{
-			if (jointProba[i][j] != 0 && proba1[i] != 0 && proba2[j] != 0) { res += jointProba[i][j] * log(jointProba[i][j] / proba1[i] / proba2[j]); }
+			if (subsets[s].empty()) { continue; }
+			const SSubset subset { &subsets[s], m_classCodes.data(), m_classCounts.size() };
+			SProgress progress;
+			progress.callback = [&selected, s](const SSelected& feature)
+			{
+				if (!std::isnan(feature.score)) { selected[s].push_back(feature.feature); }
+				return true;
+			};
+			res.selections[s] = mRMR(nFeatures, method, sequential, &subset, &progress);
 		}
-	}
-	res /= log(2);
+	}, 1);
+
+	// Frequency of each feature in the non-empty selections
+	const size_t nSelections = size_t(count_if(res.selections.begin(), res.selections.end(), [](const vector<size_t>& selection) { return !selection.empty(); }));
+	if (nSelections == 0) { return SStability(); }
+	res.frequencies.assign(m_nFeatures, 0.0);
+	for (const auto& features : selected) { for (const auto& f : features) { res.frequencies[f]++; } }
+	for (auto& f : res.frequencies) { f /= double(nSelections); }
 	return res;
 }
 ///-------------------------------------------------------------------------------------------------
 
 ///-------------------------------------------------------------------------------------------------
-vector<size_t> CMRMR::mRMR(const size_t nFeatures, const EMRMRMethod method) const
+bool CMRMR::serve(const CSocket& listener, const size_t nThreads)
 {
-	if (nFeatures == 0) { return vector<size_t>(); }
-	const size_t n = ((nFeatures < m_nFeatures) ? nFeatures : m_nFeatures);
-	vector<size_t> res(n);
+	if (isSparse())
+	{
+		cerr << "Sparse datas can't be served." << endl;
+		return false;
+	}
+	CSocket coordinator;
+	if (!listener.accept(coordinator))
+	{
+		cerr << "Coordinator can't be accepted." << endl;
+		return false;
+	}
 
-	// Initialize selection
-	vector<double> mutualInfos;
-	vector<bool> mask(m_nFeatures, true);
-	mutualInfos.reserve(m_nFeatures);
-	for (size_t i = 0; i < m_nFeatures; ++i) { mutualInfos.push_back(mutualInfo(size_t(-1), i)); }	// Compute Mutual infos with classId
+	CThreadPool pool(nThreads);
+	EMRMRMethod method = EMRMRMethod::MID;
+	size_t nSelected   = 0;			// Number of selected features (in all shards)
+	vector<double> relevances;		// Mutual info of each feature of the shard with the classification target
+	vector<double> redundancies;	// Running sum of the mutual infos with the selected features
+	vector<double> scores;			// Score of each remaining candidate (in the candidates order)
+	vector<size_t> candidates;		// Remaining candidates of the shard in descending relevance order
+	vector<code_t> received;		// Column of the last selected feature (if it's not in the shard)
+	vector<uint64_t> planes;		// Bit planes of the received column (empty if it has too many states)
+	size_t planeCounts[MutualInfo::MAX_BIT_STATES];
+
+	// Best candidate of the shard, sequential scan in candidates order as mRMR
+	const auto sendBest = [&]()
+	{
+		SShardBest best { 0, 0, numeric_limits<double>::min(), 0.0 };
+		if (nSelected == 0 && !candidates.empty()) { best = { 1, candidates[0], relevances[candidates[0]], relevances[candidates[0]] }; }
+		for (size_t k = 0; nSelected != 0 && k < candidates.size(); ++k)
+		{
+			if (best.score < scores[k]) { best = { 1, candidates[k], scores[k], relevances[candidates[k]] }; }
+		}
+		return sendValue(coordinator, best);
+	};
+
+	while (true)
+	{
+		EShardMessage type;
+		bool connected = receiveValue(coordinator, type);
+		if (connected && type == EShardMessage::Stop) { return true; }
+		if (connected && type == EShardMessage::Start)
+		{
+			// Encoding and relevance of the features of the shard
+			SShardStart start;
+			connected = receiveValue(coordinator, start);
+			if (connected && start.method != uint64_t(EMRMRMethod::MID) && start.method != uint64_t(EMRMRMethod::MIQ))
+			{
+				cerr << "Unknown method from the coordinator : " << start.method << endl;
+				return false;
+			}
+			method    = EMRMRMethod(start.method);
+			nSelected = 0;
+			candidates.clear();
+			const bool encoded = connected && m_nSamples != 0 && m_nFeatures != 0 && prepare(start.threshold, pool);
+			if (encoded)
+			{
+				CPhaseTimer relevanceTimer(m_runStats, EPhase::Relevance);
+				SCountsTable* classTable = countsTable(size_t(-1));
+				relevances.resize(m_nFeatures);
+				pool.parallelFor(m_nFeatures, [&](const size_t begin, const size_t end)
+				{
+					for (size_t i = begin; i < end; ++i) { relevances[i] = mutualInfo(size_t(-1), i, classTable); }
+				});
+				for (size_t f = 0; f < m_nFeatures; ++f) { if (m_ignored.empty() || m_ignored[f] == 0) { candidates.push_back(f); } }	// The features with too many states are ignored (see statesRange)
+				stable_sort(candidates.begin(), candidates.end(), [&relevances](const size_t i1, const size_t i2) { return relevances[i1] > relevances[i2]; });
+				redundancies.assign(m_nFeatures, 0.0);
+				scores.resize(m_nFeatures);
+			}
+			const SShardInfo info { encoded ? 1u : 0u, m_nFeatures, m_nSamples };
+			connected = connected && sendValue(coordinator, info) && sendBest();
+		}
+		else if (connected && type == EShardMessage::Select)
+		{
+			// The column of the selected feature is sent by its shard to the coordinator, or received from the coordinator
+			uint64_t feature, nStates = 0;
+			const code_t* selected = nullptr;
+			connected              = receiveValue(coordinator, feature);
+			if (connected && feature != uint64_t(-1))
+			{
+				if (feature >= m_nFeatures || !hasCodes())
+				{
+					cerr << "Feature " << feature << " not in the encoded shard : " << m_nFeatures << " features" << endl;
+					return false;
+				}
+				selected  = column(size_t(feature));
+				nStates   = m_nStates[size_t(feature)];
+				connected = sendValue(coordinator, nStates) && coordinator.send(selected, m_nSamples * sizeof(code_t));
+				const auto it = find(candidates.begin(), candidates.end(), size_t(feature));
+				if (it != candidates.end()) { candidates.erase(it); }
+			}
+			else if (connected)
+			{
+				received.resize(m_nSamples);
+				connected = receiveValue(coordinator, nStates) && coordinator.receive(received.data(), m_nSamples * sizeof(code_t));
+				selected  = received.data();
+				if (connected && (nStates == 0 || nStates > size_t(numeric_limits<code_t>::max()) + 1
+								  || any_of(received.begin(), received.end(), [nStates](const code_t c) { return c >= nStates; })))
+				{
+					cerr << "Column received with invalid states : " << nStates << " states" << endl;
+					return false;
+				}
+				planes.clear();
+				if (connected && hasCodes() && nStates <= MutualInfo::MAX_BIT_STATES)
+				{
+					planes.assign(size_t(nStates) * MutualInfo::nWords(m_nSamples), 0);
+					MutualInfo::buildBitPlanes(selected, size_t(nStates), m_nSamples, planes.data(), planeCounts);
+				}
+			}
+
+			// Same mutual infos and summation order than mRMR, the owned features use the kernels and the joint counts tables of a single process
+			if (connected)
+			{
+				CPhaseTimer redundancyTimer(m_runStats, EPhase::Redundancy);
+				const bool owned    = feature != uint64_t(-1);
+				SCountsTable* table = owned ? countsTable(size_t(feature)) : nullptr;
+				const auto receivedInfo = [&](const size_t id)
+				{
+					MutualInfo::SWorkspace& ws = workspace();
+					const size_t p             = m_planeIdx[id];
+					if (!planes.empty() && p != size_t(-1) && MutualInfo::useBitPlanes(size_t(nStates), m_nStates[id]))
+					{
+						MutualInfo::bitPlanesCounts(planes.data(), planeCounts, size_t(nStates), &m_planes[p * MutualInfo::nWords(m_nSamples)], &m_planeCounts[p], m_nStates[id],
+													m_nSamples, ws.counts);
+					}
+					else { MutualInfo::genericCounts(selected, size_t(nStates), column(id), m_nStates[id], m_nSamples, ws.counts); }
+					return MutualInfo::fromCounts(ws, size_t(nStates), m_nStates[id], m_nSamples);
+				};
+				nSelected++;
+				pool.parallelFor(candidates.size(), [&](const size_t begin, const size_t end)
+				{
+					for (size_t k = begin; k < end; ++k)
+					{
+						const size_t id        = candidates[k];
+						const double relevance = relevances[id];
+						redundancies[id] += owned ? mutualInfo(size_t(feature), id, table) : receivedInfo(id);
+						const double redundancy = redundancies[id] / double(nSelected);
+						scores[k]               = (method == EMRMRMethod::MID) ? relevance - redundancy : relevance / (redundancy + 0.0001);
+					}
+				});
+				redundancyTimer.stop();
+				connected = sendBest();
+			}
+		}
+		else if (connected)
+		{
+			cerr << "Unknown message from the coordinator : " << uint32_t(type) << endl;
+			return false;
+		}
+		if (!connected)
+		{
+			cerr << "Connection with the coordinator lost." << endl;
+			return false;
+		}
+	}
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::serve(const uint16_t port, const size_t nThreads)
+{
+	CSocket listener;
+	if (!listener.listen(port))
+	{
+		cerr << "Port " << port << " can't be listened." << endl;
+		return false;
+	}
+	return serve(listener, nThreads);
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+vector<size_t> CMRMR::processSharded(const vector<pair<string, uint16_t>>& workers, const double threshold, const size_t nFeatures, const EMRMRMethod method)
+{
+	if (workers.empty() || nFeatures == 0) { return vector<size_t>(); }
+	vector<CSocket> sockets(workers.size());
+	vector<SShardBest> bests(workers.size());
+	vector<size_t> offsets(workers.size() + 1, 0);	// First feature of each shard (and number of features at the end)
+	const auto stop = [&sockets]()
+	{
+		for (const auto& s : sockets) { if (s.isOpen()) { sendValue(s, EShardMessage::Stop); } }
+		return vector<size_t>();
+	};
+	const auto lost = [&](const size_t w)
+	{
+		cerr << "Connection with the worker " << workers[w].first << ":" << workers[w].second << " lost." << endl;
+		return stop();
+	};
+
+	// Encoding and relevance of each shard (all workers start before the first answer)
+	const SShardStart start { threshold, uint64_t(method) };
+	for (size_t w = 0; w < workers.size(); ++w)
+	{
+		if (!sockets[w].connect(workers[w].first, workers[w].second))
+		{
+			cerr << "Worker " << workers[w].first << ":" << workers[w].second << " can't be reached." << endl;
+			return stop();
+		}
+		if (!sendValue(sockets[w], EShardMessage::Start, start)) { return lost(w); }
+	}
+	size_t nSamples = 0;
+	for (size_t w = 0; w < workers.size(); ++w)
+	{
+		SShardInfo info;
+		if (!receiveValue(sockets[w], info) || !receiveValue(sockets[w], bests[w])) { return lost(w); }
+		if (info.ok == 0)
+		{
+			cerr << "Worker " << workers[w].first << ":" << workers[w].second << " can't encode its features." << endl;
+			return stop();
+		}
+		if (w != 0 && info.nSamples != nSamples)
+		{
+			cerr << "Worker " << workers[w].first << ":" << workers[w].second << " has not same number of samples : " << info.nSamples << " expected : " << nSamples << endl;
+			return stop();
+		}
+		nSamples       = size_t(info.nSamples);
+		offsets[w + 1] = offsets[w] + size_t(info.nFeatures);
+	}
+
+	// Greedy selection, the ties are broken as the candidates order of a single process (descending relevance, then ascending index)
+	const size_t n = min(nFeatures, offsets.back());
+	vector<size_t> res(n, 0);
+	vector<code_t> selected(nSamples);
+	for (size_t i = 0; i < n; ++i)
+	{
+		size_t winner = workers.size();
+		for (size_t w = 0; w < workers.size(); ++w)
+		{
+			if (bests[w].found == 0) { continue; }
+			if (winner == workers.size() || bests[winner].score < bests[w].score
+				|| (bests[winner].score == bests[w].score && bests[winner].relevance < bests[w].relevance)) { winner = w; }
+		}
+		if (winner != workers.size()) { res[i] = offsets[winner] + size_t(bests[winner].feature); }	// Otherwise the first feature as a single process
+		if (i + 1 == n) { break; }
+
+		// The column of the selected feature is sent by its worker to the others, then each worker sends its new best candidate
+		const size_t owner = size_t(upper_bound(offsets.begin(), offsets.end(), res[i]) - offsets.begin()) - 1;
+		uint64_t nStates;
+		if (!sendValue(sockets[owner], EShardMessage::Select, uint64_t(res[i] - offsets[owner])) || !receiveValue(sockets[owner], nStates)
+			|| !sockets[owner].receive(selected.data(), nSamples * sizeof(code_t))) { return lost(owner); }
+		for (size_t w = 0; w < workers.size(); ++w)
+		{
+			if (w == owner) { continue; }
+			if (!sendValue(sockets[w], EShardMessage::Select, uint64_t(-1)) || !sendValue(sockets[w], nStates)
+				|| !sockets[w].send(selected.data(), nSamples * sizeof(code_t))) { return lost(w); }
+		}
+		for (size_t w = 0; w < workers.size(); ++w) { if (!receiveValue(sockets[w], bests[w])) { return lost(w); } }
+	}
+	stop();
+	return res;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::save(const std::string& filename) const
+{
+	if (!hasRawDatas())
+	{
+		cerr << "Raw datas are not available (streaming mode or sparse datas)." << endl;
+		return false;
+	}
+	ofstream file(filename, ios::binary);
+	if (!file.is_open())
+	{
+		cerr << "File cannot be opened." << endl;
+		return false;
+	}
+
+	const bool withCodes = hasCodes();
+	SFileHeader header;
+	header.nFeatures = m_nFeatures;
+	header.nSamples  = m_nSamples;
+	header.threshold = withCodes ? m_codesThreshold : numeric_limits<double>::quiet_NaN();
+	header.binning   = uint32_t(m_codesBinning);
+	header.nBins     = uint32_t(m_codesBins);
+	header.classes   = alignOffset(sizeof(SFileHeader));
+	header.datas     = alignOffset(header.classes + m_nSamples * sizeof(int32_t));
+	header.states    = withCodes ? alignOffset(header.datas + m_nFeatures * m_nSamples * sizeof(double)) : 0;
+	header.codes     = withCodes ? alignOffset(header.states + m_nFeatures * sizeof(uint64_t)) : 0;
+
+	// Sections are written in order with a padding to be aligned
+	const auto pad = [&file](const uint64_t offset) { while (uint64_t(file.tellp()) < offset) { file.put(0); } };
+	file.write(reinterpret_cast<const char*>(&header), sizeof(SFileHeader));
+	pad(header.classes);
+	vector<int32_t> classes(m_nSamples);
+	for (const auto& c : m_classes) { for (const auto& i : c.second) { classes[i] = int32_t(c.first); } }
+	file.write(reinterpret_cast<const char*>(classes.data()), streamsize(classes.size() * sizeof(int32_t)));
+	pad(header.datas);
+	vector<double> values;	// Column converted in double (single precision)
+	for (size_t j = 0; j < m_nFeatures; ++j)
+	{
+		if (isFloat())
+		{
+			values.assign(m_floatDatas.begin() + ptrdiff_t(j * m_stride), m_floatDatas.begin() + ptrdiff_t(j * m_stride + m_nSamples));
+			file.write(reinterpret_cast<const char*>(values.data()), streamsize(m_nSamples * sizeof(double)));
+		}
+		else { file.write(reinterpret_cast<const char*>(rawColumn(j)), streamsize(m_nSamples * sizeof(double))); }
+	}
+	if (withCodes)
+	{
+		pad(header.states);
+		const vector<uint64_t> states(m_nStates.begin(), m_nStates.end());
+		file.write(reinterpret_cast<const char*>(states.data()), streamsize(states.size() * sizeof(uint64_t)));
+		pad(header.codes);
+		file.write(reinterpret_cast<const char*>(column(0)), streamsize(m_nFeatures * m_nSamples * sizeof(code_t)));
+	}
+	if (!file.good())
+	{
+		cerr << "File cannot be written." << endl;
+		return false;
+	}
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::load(const std::string& filename)
+{
+	CPhaseTimer timer(m_runStats, EPhase::Read);
+	reset();
+	shared_ptr<CMappedFile> file = make_shared<CMappedFile>();
+	if (!file->open(filename))
+	{
+		cerr << "File cannot be opened." << endl;
+		return false;
+	}
+
+	// Check the header and the size of each section
+	SFileHeader header;
+	if (file->size() < sizeof(SFileHeader))
+	{
+		cerr << "Header can not be read." << endl;
+		return false;
+	}
+	memcpy(&header, file->data(), sizeof(SFileHeader));
+	const SFileHeader ref;
+	if (memcmp(header.magic, ref.magic, sizeof(ref.magic)) != 0 || header.endianness != ref.endianness)
+	{
+		cerr << "Not a mRMR binary file (or not the same endianness)." << endl;
+		return false;
+	}
+	if (header.version != ref.version)
+	{
+		cerr << "Version of the file not supported : " << header.version << " expected : " << ref.version << endl;
+		return false;
+	}
+	// Each section is aligned, after the previous one and in the file
+	const bool withCodes = header.codes != 0;
+	uint64_t next        = sizeof(SFileHeader);
+	const auto section   = [&](const uint64_t offset, const uint64_t count, const uint64_t size)
+	{
+		if (offset < next || offset % ALIGNMENT != 0 || offset > file->size() || count > (file->size() - offset) / size) { return false; }
+		next = offset + count * size;
+		return true;
+	};
+	const bool overflow = header.nSamples != 0 && header.nFeatures > numeric_limits<uint64_t>::max() / header.nSamples;
+	if (overflow || !section(header.classes, header.nSamples, sizeof(int32_t)) || !section(header.datas, header.nFeatures * header.nSamples, sizeof(double))
+		|| (withCodes && (!section(header.states, header.nFeatures, sizeof(uint64_t)) || !section(header.codes, header.nFeatures * header.nSamples, sizeof(code_t)))))
+	{
+		cerr << "File is truncated or corrupted." << endl;
+		return false;
+	}
+
+	// The codes of each feature are in its states (the kernels index their tables with the codes)
+	if (withCodes)
+	{
+		const auto* states = reinterpret_cast<const uint64_t*>(file->data() + header.states);
+		const auto* codes  = reinterpret_cast<const code_t*>(file->data() + header.codes);
+		for (size_t j = 0; j < header.nFeatures; ++j)
+		{
+			const uint64_t nStates = states[j];
+			const code_t* col      = codes + j * header.nSamples;
+			if (nStates == 0 || nStates > uint64_t(numeric_limits<code_t>::max()) + 1
+				|| any_of(col, col + header.nSamples, [nStates](const code_t c) { return c >= nStates; }))
+			{
+				cerr << "Codes of the feature " << j << " are corrupted : " << nStates << " states" << endl;
+				return false;
+			}
+		}
+	}
+
+	// Datas and codes are used in place
+	m_nFeatures    = size_t(header.nFeatures);
+	m_nSamples     = size_t(header.nSamples);
+	m_stride       = m_nSamples;
+	m_mappedDatas  = reinterpret_cast<const double*>(file->data() + header.datas);
+	const auto* classes = reinterpret_cast<const int32_t*>(file->data() + header.classes);
+	for (size_t i = 0; i < m_nSamples; ++i) { m_classes[int(classes[i])].push_back(i); }
+	if (withCodes)
+	{
+		const auto* states = reinterpret_cast<const uint64_t*>(file->data() + header.states);
+		m_nStates.assign(states, states + m_nFeatures);
+		m_ignored.assign(m_nFeatures, 0);
+		m_mappedCodes    = reinterpret_cast<const code_t*>(file->data() + header.codes);
+		m_codesThreshold = header.threshold;
+		m_codesBinning   = EBinning(header.binning);
+		m_codesBins      = size_t(header.nBins);
+		m_nEncoded       = m_nSamples;
+	}
+	m_file = std::move(file);
+	updateWorkingSet();
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::saveMutualInfos(const std::string& filename, const double threshold, const EPrecision precision, const size_t top, const size_t nThreads)
+{
+	if (m_nSamples == 0 || m_nFeatures == 0 || isSparse())
+	{
+		cerr << "The mutual infos can only be saved for dense datas." << endl;
+		return false;
+	}
+	CThreadPool pool(nThreads);
+	if (!prepare(threshold, pool)) { return false; }
+
+	// Relevances of all features, the matrix contains all features or the best ones by relevance
+	vector<double> relevances(m_nFeatures);
+	pool.parallelFor(m_nFeatures, [&](const size_t begin, const size_t end) { for (size_t i = begin; i < end; ++i) { relevances[i] = mutualInfo(size_t(-1), i); } });
+	vector<size_t> features(m_nFeatures);
+	iota(features.begin(), features.end(), 0);
+	if (top != 0 && top < m_nFeatures)
+	{
+		stable_sort(features.begin(), features.end(), [&relevances](const size_t i1, const size_t i2) { return relevances[i1] > relevances[i2]; });
+		features.resize(top);
+		sort(features.begin(), features.end());
+	}
+	const size_t n    = features.size();
+	const bool single = precision == EPrecision::Float;
+
+	SInfosHeader header;
+	header.fingerprint = fingerprint();
+	header.nFeatures   = m_nFeatures;
+	header.nSamples    = m_nSamples;
+	header.nMatrix     = n;
+	header.precision   = uint32_t(precision);
+	header.relevances  = alignOffset(sizeof(SInfosHeader));
+	header.features    = alignOffset(header.relevances + m_nFeatures * sizeof(double));
+	header.infos       = alignOffset(header.features + n * sizeof(uint64_t));
+	const uint64_t size = header.infos + (single ? n * (n - 1) / 2 * sizeof(float) : n * n * sizeof(double));
+
+	// The mutual infos are written in place in the mapped file (the file can be bigger than the memory)
+	CMappedFile file;
+	if (!file.create(filename, size_t(size), false))
+	{
+		cerr << "File cannot be created." << endl;
+		return false;
+	}
+	char* base = file.writableData();
+	memcpy(base, &header, sizeof(SInfosHeader));
+	memcpy(base + header.relevances, relevances.data(), m_nFeatures * sizeof(double));
+	auto* ids = reinterpret_cast<uint64_t*>(base + header.features);
+	for (size_t k = 0; k < n; ++k) { ids[k] = features[k]; }
+	auto* square   = reinterpret_cast<double*>(base + header.infos);
+	auto* triangle = reinterpret_cast<float*>(base + header.infos);
+
+	// Each task computes the mutual infos between two blocks of features, the joint counts are computed once for the two orders
+	const size_t block = 64, nBlocks = (n + block - 1) / block;
+	vector<pair<size_t, size_t>> tiles;
+	for (size_t a = 0; a < nBlocks; ++a) { for (size_t b = a; b < nBlocks; ++b) { tiles.emplace_back(a, b); } }
+	pool.parallelFor(tiles.size(), [&](const size_t begin, const size_t end)
+	{
+		MutualInfo::SWorkspace& ws = workspace();
+		vector<double> transposed;
+		for (size_t t = begin; t < end; ++t)
+		{
+			const size_t lastA = min(n, (tiles[t].first + 1) * block), lastB = min(n, (tiles[t].second + 1) * block);
+			for (size_t a = tiles[t].first * block; a < lastA; ++a)
+			{
+				if (!single && tiles[t].first == tiles[t].second) { square[a * n + a] = 0; }
+				for (size_t b = max(a + 1, tiles[t].second * block); b < lastB; ++b)
+				{
+					size_t n1, n2;
+					jointCounts(features[a], features[b], ws.counts, n1, n2);
+					if (single)
+					{
+						triangle[a * n - a * (a + 1) / 2 + b - a - 1] = float(MutualInfo::fromCounts(ws, n1, n2, m_nSamples));
+						continue;
+					}
+					transposed.resize(n1 * n2);
+					for (size_t i = 0; i < n1; ++i) { for (size_t j = 0; j < n2; ++j) { transposed[j * n1 + i] = ws.counts[i * n2 + j]; } }
+					square[a * n + b] = MutualInfo::fromCounts(ws, n1, n2, m_nSamples);
+					ws.counts.swap(transposed);
+					square[b * n + a] = MutualInfo::fromCounts(ws, n2, n1, m_nSamples);
+				}
+			}
+		}
+	});
+	if (!file.flush())
+	{
+		file.close();
+		remove(filename.c_str());
+		cerr << "File cannot be written." << endl;
+		return false;
+	}
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::loadMutualInfos(const std::string& filename)
+{
+	m_infos = SInfosMatrix();
+	shared_ptr<CMappedFile> file = make_shared<CMappedFile>();
+	if (!file->open(filename))
+	{
+		cerr << "File cannot be opened." << endl;
+		return false;
+	}
+
+	// Check the header, the datas and the size of each section
+	SInfosHeader header;
+	if (file->size() < sizeof(SInfosHeader))
+	{
+		cerr << "Header can not be read." << endl;
+		return false;
+	}
+	memcpy(&header, file->data(), sizeof(SInfosHeader));
+	const SInfosHeader ref;
+	if (memcmp(header.magic, ref.magic, sizeof(ref.magic)) != 0 || header.endianness != ref.endianness)
+	{
+		cerr << "Not a mRMR mutual infos file (or not the same endianness)." << endl;
+		return false;
+	}
+	if (header.version != ref.version)
+	{
+		cerr << "Version of the file not supported : " << header.version << " expected : " << ref.version << endl;
+		return false;
+	}
+	if (header.nFeatures != m_nFeatures || header.nSamples != m_nSamples)
+	{
+		cerr << "The mutual infos are not computed on these datas : " << header.nFeatures << " features and " << header.nSamples << " samples VS "
+				<< m_nFeatures << " features and " << m_nSamples << " samples" << endl;
+		return false;
+	}
+	// Each section is after the previous one and the last one is in the file
+	const bool single  = header.precision == uint32_t(EPrecision::Float);
+	const uint64_t n   = header.nMatrix;
+	const uint64_t end = (n > m_nFeatures) ? 0 : header.infos + (single ? n * (n - 1) / 2 * sizeof(float) : n * n * sizeof(double));
+	if (n > m_nFeatures || header.relevances < sizeof(SInfosHeader) || header.relevances > header.features || header.features - header.relevances < m_nFeatures * sizeof(double)
+		|| header.features > header.infos || header.infos - header.features < n * sizeof(uint64_t) || end < header.infos || file->size() < end
+		|| header.relevances % ALIGNMENT != 0 || header.features % ALIGNMENT != 0 || header.infos % ALIGNMENT != 0)
+	{
+		cerr << "File is truncated or corrupted." << endl;
+		return false;
+	}
+	const auto* features = reinterpret_cast<const uint64_t*>(file->data() + header.features);
+	vector<size_t> positions(m_nFeatures, size_t(-1));
+	for (size_t k = 0; k < n; ++k)
+	{
+		if (features[k] >= m_nFeatures)
+		{
+			cerr << "File is truncated or corrupted." << endl;
+			return false;
+		}
+		positions[features[k]] = k;
+	}
+
+	// The mutual infos are used in place, once the codes are checked by prepare
+	m_infos.fingerprint = header.fingerprint;
+	m_infos.n           = size_t(n);
+	m_infos.single      = single;
+	m_infos.relevances  = reinterpret_cast<const double*>(file->data() + header.relevances);
+	m_infos.infos       = file->data() + header.infos;
+	m_infos.positions.swap(positions);
+	m_infos.file = std::move(file);
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------- Private Functions --------------------
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::prepare(const double threshold, CThreadPool& pool)
+{
+	// Previous codes are kept if they are computed with the same threshold, they are updated if samples are added
+	// (the quantiles of the EqualFrequency binning need all the values, the codes are computed again)
+	CPhaseTimer encodeTimer(m_runStats, EPhase::Encode);
+	encodeClasses();
+	m_infos.usable = false;
+	if (isSparse())
+	{
+		if (!sameEncoding(threshold) && !encodeSparse(threshold, pool))
+		{
+			invalidateCodes();
+			return false;
+		}
+		m_minClass     = m_classes.begin()->first;
+		m_nClassStates = m_classCounts.size();
+		updateWorkingSet();
+		return true;
+	}
+	const bool sameThreshold = sameEncoding(threshold);
+	const bool upToDate      = sameThreshold && m_nEncoded == m_nSamples && m_nStates.size() == m_nFeatures;	// Nothing to encode
+	const bool canUpdate     = !upToDate && sameThreshold && hasRawDatas() && m_stats.size() == m_nFeatures && m_minStates.size() == m_nFeatures
+							   && (!std::isinf(threshold) || m_binning != EBinning::EqualFrequency);
+	const bool appended      = sameThreshold && m_nEncoded == m_nSamples && m_nStates.size() < m_nFeatures && m_stats.size() == m_nFeatures && hasRawDatas();
+	if (appended)
+	{
+		if (!encodeAppended(threshold, pool))
+		{
+			invalidateCodes();
+			return false;
+		}
+	}
+	else if (canUpdate)
+	{
+		if (!updateCodes(threshold, pool))
+		{
+			invalidateCodes();
+			return false;
+		}
+	}
+	else if (!upToDate)
+	{
+		if (!hasRawDatas())
+		{
+			cerr << "Raw datas are not available (streaming mode or released), only the threshold " << m_codesThreshold << " can be processed." << endl;
+			return false;
+		}
+		invalidateCodes();
+		m_codes.assign(m_nFeatures * m_nSamples, 0);
+		m_nStates.assign(m_nFeatures, 0);
+		m_minStates.assign(m_nFeatures, 0);
+		m_ignored.assign(m_nFeatures, 0);
+		m_stats.assign(m_nFeatures, SFeatureStats());
+
+		// Feature by feature (column by column)
+		atomic<bool> encoded(true);
+		pool.parallelFor(m_nFeatures, [&](const size_t begin, const size_t end)
+		{
+			for (size_t j = begin; j < end; ++j) { if (!encode(j, threshold)) { encoded = false; } }
+		});
+		if (!encoded)
+		{
+			invalidateCodes();
+			return false;
+		}
+		m_codesThreshold = threshold;
+		m_codesBinning   = m_binning;
+		m_codesBins      = m_nBins;
+		m_nEncoded       = m_nSamples;
+	}
+	m_minClass     = m_classes.begin()->first;	// Also for the codes of a loaded or streamed file
+	m_nClassStates = size_t(int64_t(m_classes.rbegin()->first) - int64_t(m_minClass) + 1);
+	encodeTimer.stop();
+	if (m_planeIdx.empty())
+	{
+		CPhaseTimer planesTimer(m_runStats, EPhase::BitPlanes);
+		buildBitPlanes(pool);
+	}
+	if (m_releaseDatas) { releaseDatas(); }
+	m_infos.usable = m_infos.file != nullptr && m_infos.positions.size() == m_nFeatures && m_infos.fingerprint == fingerprint();
+	updateWorkingSet();
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::updateCodes(const double threshold, CThreadPool& pool)
+{
+	const size_t nOld     = m_nEncoded, n = m_nSamples;
+	const code_t* oldBase = column(0);
+	vector<code_t> codes(m_nFeatures * n);
+	vector<size_t> nStates(m_nFeatures);
+	vector<int> minStates(m_nFeatures);
+	vector<uint8_t> ignored(m_nFeatures, 0);
+	vector<uint8_t> relayout(m_nFeatures, 0);		// The states of the feature are shifted, the joint counts must be computed again
+	vector<vector<uint32_t>> changed(m_nFeatures);	// Old samples with a new code
+
+	// Codes with the new statistics (already updated by addSample)
+	pool.parallelFor(m_nFeatures, [&](const size_t begin, const size_t end)
+	{
+		for (size_t j = begin; j < end; ++j)
+		{
+			SEncoder enc = encoder(m_stats[j], threshold);
+			statesRange(j, m_stats[j], enc, minStates[j], nStates[j]);
+			ignored[j]     = enc.single ? 1 : 0;
+			code_t* column = &codes[j * n];
+			withRawColumn(j, [&](const auto* values) { for (size_t i = 0; i < n; ++i) { column[i] = code_t(enc.state(values[i]) - minStates[j]); } });
+			if (minStates[j] != m_minStates[j] || nStates[j] != m_nStates[j]) { relayout[j] = 1; }
+			else
+			{
+				const code_t* old = oldBase + j * nOld;
+				for (size_t i = 0; i < nOld; ++i) { if (column[i] != old[i]) { changed[j].push_back(uint32_t(i)); } }
+			}
+		}
+	});
+
+	// Class states of each sample (the class of the old samples can't change)
+	const int minClass        = m_classes.begin()->first;
+	const size_t nClassStates = size_t(int64_t(m_classes.rbegin()->first) - int64_t(minClass) + 1);
+	const bool classRelayout  = minClass != m_minClass || nClassStates != m_nClassStates;
+	const vector<int>& classes = m_classCodes;
+
+	// Update of the joint counts with the old samples with a new code and the new samples
+	for (auto it = m_tables.begin(); it != m_tables.end();)
+	{
+		const size_t a = it->first;
+		if ((a == size_t(-1)) ? classRelayout : relayout[a] != 0)
+		{
+			it = m_tables.erase(it);
+			continue;
+		}
+		SCountsTable& table = it->second;
+		const auto stateA   = [&](const bool isNew, const size_t i)
+		{
+			if (a == size_t(-1)) { return size_t(classes[i]); }
+			return size_t(isNew ? codes[a * n + i] : oldBase[a * nOld + i]);
+		};
+		const vector<uint32_t> none;
+		const vector<uint32_t>& changedA = (a == size_t(-1)) ? none : changed[a];
+		bool shifted                     = false;
+		for (size_t b = 0; b < m_nFeatures; ++b)
+		{
+			if (table.valid[b] && relayout[b])
+			{
+				table.valid[b] = 0;
+				shifted        = shifted || nStates[b] != m_nStates[b];
+			}
+		}
+		pool.parallelFor(m_nFeatures, [&](const size_t begin, const size_t end)
+		{
+			for (size_t b = begin; b < end; ++b)
+			{
+				if (!table.valid[b]) { continue; }
+				uint32_t* counts       = &table.counts[table.offsets[b]];
+				const size_t n2        = nStates[b];
+				const code_t* newB     = &codes[b * n];
+				const code_t* oldB     = oldBase + b * nOld;
+				const auto update      = [&](const size_t i)
+				{
+					counts[stateA(false, i) * n2 + oldB[i]]--;
+					counts[stateA(true, i) * n2 + newB[i]]++;
+				};
+				// Union of the changed samples of the two variables (sorted lists)
+				const vector<uint32_t>& changedB = changed[b];
+				size_t ia = 0, ib = 0;
+				while (ia < changedA.size() || ib < changedB.size())
+				{
+					if (ib == changedB.size() || (ia < changedA.size() && changedA[ia] < changedB[ib])) { update(changedA[ia++]); }
+					else if (ia == changedA.size() || changedB[ib] < changedA[ia]) { update(changedB[ib++]); }
+					else
+					{
+						update(changedA[ia++]);
+						ib++;
+					}
+				}
+				for (size_t i = nOld; i < n; ++i) { counts[stateA(true, i) * n2 + newB[i]]++; }
+			}
+		});
+		if (shifted) { layoutTable(a, table, nStates); }	// The size of some joint counts change
+		++it;
+	}
+
+	m_codes.swap(codes);
+	m_mappedCodes = nullptr;
+	if (m_mappedDatas == nullptr) { m_file.reset(); }
+	m_nStates.swap(nStates);
+	m_minStates.swap(minStates);
+	m_ignored.swap(ignored);
+	m_nEncoded     = n;
+	m_minClass     = minClass;
+	m_nClassStates = nClassStates;
+	m_planes.clear();
+	m_planeCounts.clear();
+	m_planeIdx.clear();
+	m_classPlanes.clear();
+	m_fingerprint = 0;
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::encodeAppended(const double threshold, CThreadPool& pool)
+{
+	const size_t first = m_nStates.size();
+	if (m_mappedCodes != nullptr)	// The codes of a mapped file are copied once
+	{
+		m_codes.assign(m_mappedCodes, m_mappedCodes + first * m_nEncoded);
+		m_mappedCodes = nullptr;
+		if (m_mappedDatas == nullptr) { m_file.reset(); }
+	}
+	m_codes.resize(m_nFeatures * m_nSamples, 0);
+	m_nStates.resize(m_nFeatures, 0);
+	m_minStates.resize(m_nFeatures, 0);
+	m_ignored.resize(m_nFeatures, 0);
+
+	atomic<bool> encoded(true);
+	pool.parallelFor(m_nFeatures - first, [&](const size_t begin, const size_t end)
+	{
+		for (size_t j = first + begin; j < first + end; ++j) { if (!encode(j, threshold)) { encoded = false; } }
+	});
+	if (!encoded) { return false; }
+
+	// The kept joint counts are moved in the layout with the new features (not yet counted)
+	for (auto& t : m_tables)
+	{
+		t.second.valid.resize(m_nFeatures, 0);
+		layoutTable(t.first, t.second, m_nStates);
+	}
+	if (!m_planeIdx.empty())
+	{
+		CPhaseTimer planesTimer(m_runStats, EPhase::BitPlanes);
+		buildBitPlanes(pool, first);
+	}
+	m_fingerprint = 0;
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::layoutTable(const size_t variable, SCountsTable& table, const vector<size_t>& nStates) const
+{
+	const size_t n1 = (variable == size_t(-1)) ? m_nClassStates : nStates[variable];
+	vector<size_t> offsets(m_nFeatures);
+	size_t size = 0;
+	for (size_t b = 0; b < m_nFeatures; ++b)
+	{
+		offsets[b] = size;
+		size += n1 * nStates[b];
+	}
+	vector<uint32_t> counts(size, 0);
+	if (!table.valid.empty())	// Keep the valid joint counts
+	{
+		for (size_t b = 0; b < m_nFeatures; ++b)
+		{
+			if (table.valid[b]) { copy_n(&table.counts[table.offsets[b]], n1 * nStates[b], &counts[offsets[b]]); }
+		}
+	}
+	else { table.valid.assign(m_nFeatures, 0); }
+	table.counts.swap(counts);
+	table.offsets.swap(offsets);
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+CMRMR::SCountsTable* CMRMR::countsTable(const size_t variable)
+{
+	if (!m_incremental) { return nullptr; }
+	auto it = m_tables.find(variable);
+	if (it == m_tables.end())
+	{
+		it = m_tables.emplace(variable, SCountsTable()).first;
+		layoutTable(variable, it->second, m_nStates);
+	}
+	return &it->second;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::releaseDatas()
+{
+	if (isSparse()) { return; }
+	vector<double>().swap(m_datas);
+	vector<float>().swap(m_floatDatas);
+	m_mappedDatas = nullptr;
+	if (m_mappedCodes == nullptr) { m_file.reset(); }
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::invalidateCodes()
+{
+	m_codes.clear();
+	m_nStates.clear();
+	m_planes.clear();
+	m_planeCounts.clear();
+	m_planeIdx.clear();
+	m_classPlanes.clear();
+	m_mappedCodes    = nullptr;
+	m_codesThreshold = numeric_limits<double>::quiet_NaN();
+	m_nEncoded       = 0;
+	m_minStates.clear();
+	m_ignored.clear();
+	m_tables.clear();
+	m_zeroCodes.clear();
+	m_sparseCodeCounts.clear();
+	m_sparseCodeRows.clear();
+	m_sparseCodes.clear();
+	m_fingerprint = 0;
+	if (m_mappedDatas == nullptr) { m_file.reset(); }	// Nothing else in the file
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+uint64_t CMRMR::fingerprint() const
+{
+	if (m_fingerprint != 0) { return m_fingerprint; }
+	const vector<uint64_t> states(m_nStates.begin(), m_nStates.end());
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	hash          = hashBytes(hash, states.data(), states.size() * sizeof(uint64_t));
+	hash          = hashBytes(hash, m_classCodes.data(), m_classCodes.size() * sizeof(int));
+	hash          = hashBytes(hash, column(0), m_nFeatures * m_nEncoded * sizeof(code_t));
+	m_fingerprint = (hash == 0) ? 1 : hash;	// 0 is not computed
+	return m_fingerprint;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+double CMRMR::SInfosMatrix::value(const size_t variable, const size_t feature) const
+{
+	if (variable == size_t(-1)) { return relevances[feature]; }
+	const size_t a = positions[variable], b = positions[feature];
+	if (a == size_t(-1) || b == size_t(-1) || a == b) { return numeric_limits<double>::quiet_NaN(); }
+	if (!single) { return static_cast<const double*>(infos)[a * n + b]; }
+	const size_t i = min(a, b), j = max(a, b);
+	return double(static_cast<const float*>(infos)[i * n - i * (i + 1) / 2 + j - i - 1]);
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::reserve(const size_t nSamples)
+{
+	if (nSamples <= m_stride || !hasRawDatas()) { return; }
+	convertDatas(nSamples, m_precision);
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::convertDatas(const size_t stride, const EPrecision precision)
+{
+	vector<double> datas;
+	vector<float> floats;
+	if (precision == EPrecision::Float) { floats.resize(m_nFeatures * stride); }
+	else { datas.resize(m_nFeatures * stride); }
+	for (size_t j = 0; j < m_nFeatures; ++j)
+	{
+		withRawColumn(j, [&](const auto* values)
+		{
+			if (precision == EPrecision::Float) { for (size_t i = 0; i < m_nSamples; ++i) { floats[j * stride + i] = float(values[i]); } }
+			else { copy(values, values + m_nSamples, datas.begin() + ptrdiff_t(j * stride)); }
+		});
+	}
+	m_datas.swap(datas);
+	m_floatDatas.swap(floats);
+	m_stride      = stride;
+	m_mappedDatas = nullptr;	// Datas are now owned
+	if (m_mappedCodes == nullptr) { m_file.reset(); }
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+std::vector<int> CMRMR::class2IdxVector(size_t& n) const
+{
+	vector<int> res;
+	res.resize(m_nSamples);				// Features from all samples
+	int min = numeric_limits<int>::max();
+	int max = numeric_limits<int>::min();
+
+	for (const auto& m : m_classes)
+	{
+		const int tmp = m.first;
+		if (min > tmp) { min = tmp; }
+		if (max < tmp) { max = tmp; }
+		for (const auto& sampleIdx : m.second) { res[sampleIdx] = tmp; }
+	}
+	for (auto& v : res) { v -= min; }	// transform to 0 to n Indexes
+	n = size_t(max - min + 1);
+	return res;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::encodeClasses()
+{
+	size_t nClass;
+	m_classCodes = class2IdxVector(nClass);
+	m_classCounts.assign(nClass, 0);
+	for (const auto& c : m_classCodes) { m_classCounts[size_t(c)]++; }
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::SFeatureStats::update(const double value)
+{
+	++n;
+	sum += value;
+	const double delta = value - running;
+	running += delta / double(n);
+	m2 += delta * (value - running);
+	if (min > value) { min = value; }
+	if (max < value) { max = value; }
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+int CMRMR::SEncoder::state(const double value) const
+{
+	if (single) { return 0; }
+	if (std::isinf(threshold))	// No z-score
+	{
+		switch (binning)
+		{
+			case EBinning::EqualWidth:
+			{
+				const double bin = (value - min) * scale;
+				return (bin >= double(nBins)) ? int(nBins - 1) : int(bin);	// The maximum is in the last bin
+			}
+			case EBinning::EqualFrequency: return int(upper_bound(edges.begin(), edges.end(), value) - edges.begin());
+			default: return int(round(value));
+		}
+	}
+	const double z = (value - mean) / std;
+	if (z > threshold) { return 1; }
+	if (z < -threshold) { return -1; }
+	return 0;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+CMRMR::SEncoder CMRMR::encoder(const SFeatureStats& stats, const double threshold) const
+{
+	SEncoder res;
+	res.threshold = threshold;
+	res.mean      = stats.mean();
+	res.std       = stats.std();
+	if (std::isinf(threshold))
+	{
+		res.binning = m_binning;
+		res.min     = stats.min;
+		res.nBins   = m_nBins;
+		res.scale   = (stats.max > stats.min) ? double(m_nBins) / (stats.max - stats.min) : 0;
+	}
+	return res;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::statesRange(const size_t feature, const SFeatureStats& stats, SEncoder& encoder, int& min, size_t& n)
+{
+	// The discrete state is monotonic, so the extreme states are the states of the extreme values
+	min           = encoder.state(stats.min);
+	const int max = encoder.state(stats.max);
+	n             = size_t(int64_t(max) - int64_t(min) + 1);
+	if (n > size_t(numeric_limits<code_t>::max()) + 1)
+	{
+		cerr << "too many states for feature " << feature << " : " << n << " (max " << size_t(numeric_limits<code_t>::max()) + 1 << "), the feature is ignored" << endl;
+		encoder.single = true;
+		min            = 0;
+		n              = 1;
+	}
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::encode(const size_t feature, const double threshold)
+{
+	bool res = false;
+	withRawColumn(feature, [&](const auto* values)
+	{
+		SFeatureStats stats;
+		for (size_t i = 0; i < m_nSamples; ++i) { stats.update(values[i]); }
+		m_stats[feature] = stats;
+
+		SEncoder enc = encoder(stats, threshold);
+		if (enc.binning == EBinning::EqualFrequency)	// Quantiles of the feature
+		{
+			vector<double> sorted(values, values + m_nSamples);
+			sort(sorted.begin(), sorted.end());
+			for (size_t k = 1; k < enc.nBins; ++k) { enc.edges.push_back(sorted[k * m_nSamples / enc.nBins]); }
+		}
+
+		int min;
+		size_t n;
+		statesRange(feature, stats, enc, min, n);
+		code_t* codes = &m_codes[feature * m_nSamples];
+		for (size_t i = 0; i < m_nSamples; ++i) { codes[i] = code_t(enc.state(values[i]) - min); }	// transform to 0 to n Indexes
+		m_nStates[feature]   = n;
+		m_minStates[feature] = min;
+		m_ignored[feature]   = enc.single ? 1 : 0;
+		res                  = true;
+	});
+	return res;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMRMR::encodeSparse(const double threshold, CThreadPool& pool)
+{
+	if (std::isinf(threshold) && m_binning == EBinning::EqualFrequency)
+	{
+		cerr << "EqualFrequency binning can't be used with sparse datas." << endl;
+		return false;
+	}
+	invalidateCodes();
+	m_nStates.assign(m_nFeatures, 0);
+	m_minStates.assign(m_nFeatures, 0);
+	m_ignored.assign(m_nFeatures, 0);
+	m_stats.assign(m_nFeatures, SFeatureStats());
+	m_zeroCodes.assign(m_nFeatures, 0);
+	m_sparseCodeCounts.assign(m_nFeatures, 0);
+	m_sparseCodeRows.resize(m_sparseRows.size());
+	m_sparseCodes.resize(m_sparseRows.size());
+
+	pool.parallelFor(m_nFeatures, [&](const size_t begin, const size_t end)
+	{
+		for (size_t j = begin; j < end; ++j)
+		{
+			// Statistics of the non-zero values merged with the group of zeros (same sum and extremes than the dense datas)
+			const size_t first = m_sparseOffsets[j], last = m_sparseOffsets[j + 1];
+			SFeatureStats stats;
+			for (size_t k = first; k < last; ++k) { stats.update(m_sparseValues[k]); }
+			const size_t nZeros = m_nSamples - stats.n;
+			if (nZeros != 0)
+			{
+				const double delta = -stats.running, n = double(m_nSamples);
+				stats.m2 += delta * delta * double(stats.n) * double(nZeros) / n;
+				stats.running += delta * double(nZeros) / n;
+				stats.n   = m_nSamples;
+				stats.min = std::min(stats.min, 0.0);
+				stats.max = std::max(stats.max, 0.0);
+			}
+			m_stats[j] = stats;
+
+			SEncoder enc = encoder(stats, threshold);
+			int min;
+			statesRange(j, stats, enc, min, m_nStates[j]);
+			m_ignored[j]      = enc.single ? 1 : 0;
+			m_minStates[j]    = min;
+			const code_t zero = code_t(enc.state(0.0) - min);
+			m_zeroCodes[j]    = zero;
+			size_t count      = first;
+			for (size_t k = first; k < last; ++k)
+			{
+				const code_t code = code_t(enc.state(m_sparseValues[k]) - min);
+				if (code == zero) { continue; }	// Counted with the zeros
+				m_sparseCodeRows[count] = m_sparseRows[k];
+				m_sparseCodes[count++]  = code;
+			}
+			m_sparseCodeCounts[j] = count - first;
+		}
+	});
+	m_codesThreshold = threshold;
+	m_codesBinning   = m_binning;
+	m_codesBins      = m_nBins;
+	m_nEncoded       = m_nSamples;
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::buildBitPlanes(CThreadPool& pool, const size_t first)
+{
+	const size_t words = MutualInfo::nWords(m_nSamples);
+
+	// Features with few states (index of the first plane of each feature), the planes of the previous features are kept
+	size_t nPlanes = (first == 0) ? 0 : m_planeCounts.size();
+	if (first == 0)
+	{
+		m_planes.clear();
+		m_planeCounts.clear();
+	}
+	m_planeIdx.resize(first);
+	m_planeIdx.resize(m_nFeatures, size_t(-1));
+	for (size_t j = first; j < m_nFeatures; ++j)
+	{
+		if (m_nStates[j] > MutualInfo::MAX_BIT_STATES) { continue; }
+		m_planeIdx[j] = nPlanes;
+		nPlanes += m_nStates[j];
+	}
+	m_planes.resize(nPlanes * words, 0);
+	m_planeCounts.resize(nPlanes, 0);
+	pool.parallelFor(m_nFeatures - first, [&](const size_t begin, const size_t end)
+	{
+		for (size_t j = first + begin; j < first + end; ++j)
+		{
+			const size_t p = m_planeIdx[j];
+			if (p != size_t(-1)) { MutualInfo::buildBitPlanes(column(j), m_nStates[j], m_nSamples, &m_planes[p * words], &m_planeCounts[p]); }
+		}
+	});
+	if (first != 0) { return; }
+
+	// Classification target (the counts of each state are computed by encodeClasses)
+	m_classPlanes.clear();
+	if (m_classCounts.size() > MutualInfo::MAX_BIT_STATES) { return; }
+	m_classPlanes.assign(m_classCounts.size() * words, 0);
+	for (size_t i = 0; i < m_nSamples; ++i) { m_classPlanes[size_t(m_classCodes[i]) * words + i / 64] |= uint64_t(1) << (i % 64); }
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::jointCounts(const size_t feature1, const size_t feature2, vector<double>& counts, size_t& n1, size_t& n2) const
+{
+	if (isSparse())
+	{
+		sparseCounts(feature1, feature2, counts, n1, n2);
+		return;
+	}
+
+	// Bit planes kernel if both variables have planes and the popcount passes cost less than the generic kernel
+	const size_t words = MutualInfo::nWords(m_nSamples);
+	const bool planes1 = (feature1 != size_t(-1)) ? m_planeIdx[feature1] != size_t(-1) : !m_classPlanes.empty();
+	const bool planes2 = (feature2 != size_t(-1)) ? m_planeIdx[feature2] != size_t(-1) : !m_classPlanes.empty();
+	n1                 = (feature1 != size_t(-1)) ? m_nStates[feature1] : m_classCounts.size();
+	n2                 = (feature2 != size_t(-1)) ? m_nStates[feature2] : m_classCounts.size();
+	if (planes1 && planes2 && MutualInfo::useBitPlanes(n1, n2))
+	{
+		const uint64_t* p1 = (feature1 != size_t(-1)) ? &m_planes[m_planeIdx[feature1] * words] : m_classPlanes.data();
+		const uint64_t* p2 = (feature2 != size_t(-1)) ? &m_planes[m_planeIdx[feature2] * words] : m_classPlanes.data();
+		const size_t* c1   = (feature1 != size_t(-1)) ? &m_planeCounts[m_planeIdx[feature1]] : m_classCounts.data();
+		const size_t* c2   = (feature2 != size_t(-1)) ? &m_planeCounts[m_planeIdx[feature2]] : m_classCounts.data();
+		MutualInfo::bitPlanesCounts(p1, c1, n1, p2, c2, n2, m_nSamples, counts);
+		return;
+	}
+
+	// Generic kernel
+	if (feature1 != size_t(-1) && feature2 != size_t(-1))
+	{
+		MutualInfo::genericCounts(column(feature1), n1, column(feature2), n2, m_nSamples, counts);
+		return;
+	}
+
+	const int* classes = m_classCodes.data();
+	if (feature1 != size_t(-1)) { MutualInfo::genericCounts(column(feature1), n1, classes, n2, m_nSamples, counts); }
+	else if (feature2 != size_t(-1)) { MutualInfo::genericCounts(classes, n1, column(feature2), n2, m_nSamples, counts); }
+	else { MutualInfo::genericCounts(classes, n1, classes, n2, m_nSamples, counts); }
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::sparseCounts(const size_t feature1, const size_t feature2, vector<double>& counts, size_t& n1, size_t& n2) const
+{
+	if (feature1 == size_t(-1) && feature2 == size_t(-1))	// Entropy of the classification target
+	{
+		n1 = n2 = m_classCounts.size();
+		MutualInfo::genericCounts(m_classCodes.data(), n1, m_classCodes.data(), n2, m_nSamples, counts);
+		return;
+	}
+	if (feature1 == size_t(-1) || feature2 == size_t(-1))
+	{
+		// The samples of each class not in the encoded values of the feature are in its zero state (the joint counts are transposed if the feature is first)
+		const size_t feature = (feature1 == size_t(-1)) ? feature2 : feature1;
+		const size_t first   = m_sparseOffsets[feature], last = first + m_sparseCodeCounts[feature];
+		const size_t zero    = m_zeroCodes[feature], nStates = m_nStates[feature], nClass = m_classCounts.size();
+		const bool classRows = feature1 == size_t(-1);
+		const size_t cStride = classRows ? nStates : 1, sStride = classRows ? 1 : nClass;
+		n1                   = classRows ? nClass : nStates;
+		n2                   = classRows ? nStates : nClass;
+		counts.assign(n1 * n2, 0.0);
+		for (size_t k = first; k < last; ++k) { counts[size_t(m_classCodes[m_sparseCodeRows[k]]) * cStride + m_sparseCodes[k] * sStride]++; }
+		for (size_t c = 0; c < nClass; ++c)
+		{
+			double encoded = 0;
+			for (size_t state = 0; state < nStates; ++state) { encoded += counts[c * cStride + state * sStride]; }	// The zero state is still empty
+			counts[c * cStride + zero * sStride] = double(m_classCounts[c]) - encoded;
+		}
+		return;
+	}
+
+	const size_t first2 = m_sparseOffsets[feature2], last2 = first2 + m_sparseCodeCounts[feature2];
+	const size_t zero2  = m_zeroCodes[feature2];
+	n2                  = m_nStates[feature2];
+
+	// Merge of the encoded values of the two features (sorted by sample), the samples in none of them are in the two zero states
+	const size_t first1 = m_sparseOffsets[feature1], last1 = first1 + m_sparseCodeCounts[feature1];
+	const size_t zero1  = m_zeroCodes[feature1];
+	n1                  = m_nStates[feature1];
+	counts.assign(n1 * n2, 0.0);
+	size_t k1 = first1, k2 = first2, both = 0;
+	while (k1 < last1 || k2 < last2)
+	{
+		if (k2 == last2 || (k1 < last1 && m_sparseCodeRows[k1] < m_sparseCodeRows[k2])) { counts[m_sparseCodes[k1++] * n2 + zero2]++; }
+		else if (k1 == last1 || m_sparseCodeRows[k2] < m_sparseCodeRows[k1]) { counts[zero1 * n2 + m_sparseCodes[k2++]]++; }
+		else
+		{
+			counts[m_sparseCodes[k1++] * n2 + m_sparseCodes[k2++]]++;
+			both++;
+		}
+	}
+	counts[zero1 * n2 + zero2] = double(m_nSamples - (last1 - first1) - (last2 - first2) + both);
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+double CMRMR::mutualInfo(const size_t feature1, const size_t feature2) const
+{
+	if ((feature1 != size_t(-1) && feature1 >= m_nFeatures) || (feature2 != size_t(-1) && feature2 >= m_nFeatures)) { return -1; }
+	MutualInfo::SWorkspace& ws = workspace();
+	size_t n1, n2;
+	jointCounts(feature1, feature2, ws.counts, n1, n2);
+	return MutualInfo::fromCounts(ws, n1, n2, m_nSamples);
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+double CMRMR::mutualInfo(const size_t variable, const size_t feature, SCountsTable* table) const
+{
+	if (table == nullptr) { return mutualInfo(variable, feature); }
+	MutualInfo::SWorkspace& ws = workspace();
+	size_t n1, n2;
+	uint32_t* kept = &table->counts[table->offsets[feature]];
+	if (table->valid[feature])
+	{
+		n1 = (variable == size_t(-1)) ? m_nClassStates : m_nStates[variable];
+		n2 = m_nStates[feature];
+		ws.counts.assign(kept, kept + n1 * n2);
+	}
+	else
+	{
+		jointCounts(variable, feature, ws.counts, n1, n2);
+		copy(ws.counts.begin(), ws.counts.end(), kept);
+		table->valid[feature] = 1;
+	}
+	return MutualInfo::fromCounts(ws, n1, n2, m_nSamples);
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::relevanceBlock(const size_t* features, const size_t n, double* mutualInfos, SCountsTable* table) const
+{
+	thread_local vector<uint32_t> buffer;		// Joint counts of the block without table
+	thread_local vector<size_t> swept, offsets;	// Features counted in the sweep and offset of their joint counts in the buffer
+	swept.clear();
+	offsets.clear();
+	size_t size       = 0;
+	const bool narrow = m_nClassStates <= size_t(numeric_limits<code_t>::max()) + 1;	// The class states are copied in codes
+	for (size_t k = 0; k < n; ++k)
+	{
+		const size_t f = features[k];
+		if ((table != nullptr && table->valid[f]) || (m_planeIdx[f] != size_t(-1) && !m_classPlanes.empty() && MutualInfo::useBitPlanes(m_nStates[f], m_classCounts.size())) || !narrow)	// Kept joint counts, bit planes or too many classes
+		{
+			mutualInfos[f] = mutualInfo(size_t(-1), f, table);
+			continue;
+		}
+		swept.push_back(f);
+		offsets.push_back(size);
+		size += m_nClassStates * m_nStates[f];
+	}
+	if (swept.empty()) { return; }
+
+	// Joint counts (class, feature) of the block, by chunks of samples : the class states of a chunk stay in cache for all the columns of the block
+	if (table == nullptr) { buffer.assign(size, 0); }
+	const auto counts = [&](const size_t s) { return (table != nullptr) ? &table->counts[table->offsets[swept[s]]] : &buffer[offsets[s]]; };
+	if (table != nullptr) { for (size_t s = 0; s < swept.size(); ++s) { fill_n(counts(s), m_nClassStates * m_nStates[swept[s]], 0); } }
+	constexpr size_t chunk = 4096;
+	code_t classes[chunk];
+	for (size_t first = 0; first < m_nSamples; first += chunk)
+	{
+		const size_t last = min(m_nSamples, first + chunk);
+		for (size_t i = first; i < last; ++i) { classes[i - first] = code_t(m_classCodes[i]); }
+		size_t s = 0;
+		for (; s + 4 <= swept.size(); s += 4)	// Four independent joint counts by sample (the increments of a feature depend on each other)
+		{
+			const code_t *col0 = column(swept[s]) + first, *col1 = column(swept[s + 1]) + first, *col2 = column(swept[s + 2]) + first, *col3 = column(swept[s + 3]) + first;
+			const size_t n0 = m_nStates[swept[s]], n1 = m_nStates[swept[s + 1]], n2 = m_nStates[swept[s + 2]], n3 = m_nStates[swept[s + 3]];
+			uint32_t *c0 = counts(s), *c1 = counts(s + 1), *c2 = counts(s + 2), *c3 = counts(s + 3);
+			for (size_t i = 0; i < last - first; ++i)
+			{
+				c0[classes[i] * n0 + col0[i]]++;
+				c1[classes[i] * n1 + col1[i]]++;
+				c2[classes[i] * n2 + col2[i]]++;
+				c3[classes[i] * n3 + col3[i]]++;
+			}
+		}
+		for (; s < swept.size(); ++s)
+		{
+			const code_t* col = column(swept[s]) + first;
+			const size_t n2   = m_nStates[swept[s]];
+			uint32_t* c       = counts(s);
+			for (size_t i = 0; i < last - first; ++i) { c[classes[i] * n2 + col[i]]++; }
+		}
+	}
+
+	MutualInfo::SWorkspace& ws = workspace();
+	for (size_t s = 0; s < swept.size(); ++s)
+	{
+		const size_t f  = swept[s];
+		const size_t n2 = m_nStates[f];
+		ws.counts.assign(counts(s), counts(s) + m_nClassStates * n2);
+		mutualInfos[f] = MutualInfo::fromCounts(ws, m_nClassStates, n2, m_nSamples);
+		if (table != nullptr) { table->valid[f] = 1; }
+	}
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+double CMRMR::mutualInfo(const size_t variable, const size_t feature, const SSubset& subset) const
+{
+	MutualInfo::SWorkspace& ws    = workspace();
+	const vector<size_t>& samples = *subset.samples;
+	const size_t n1               = (variable == size_t(-1)) ? subset.nClass : m_nStates[variable];
+	const size_t n2               = m_nStates[feature];
+	if (variable == size_t(-1)) { MutualInfo::indexedCounts(subset.classes, n1, column(feature), n2, samples.data(), samples.size(), ws.counts); }
+	else { MutualInfo::indexedCounts(column(variable), n1, column(feature), n2, samples.data(), samples.size(), ws.counts); }
+	return MutualInfo::fromCounts(ws, n1, n2, samples.size());
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+vector<size_t> CMRMR::mRMR(const size_t nFeatures, const EMRMRMethod method, CThreadPool& pool, const SSubset* subset, const SProgress* progress,
+						   const chrono::steady_clock::time_point start)
+{
+	if (nFeatures == 0) { return vector<size_t>(); }
+	vector<size_t> indexes;	// Candidates, the features with too many states are ignored (see statesRange)
+	for (size_t f = 0; f < m_nFeatures; ++f) { if (m_ignored.empty() || m_ignored[f] == 0) { indexes.push_back(f); } }
+	const size_t nCandidates = indexes.size();
+	if (nCandidates == 0) { return vector<size_t>(); }
+	const size_t poolSize = (m_poolSize == 0) ? nCandidates : min(m_poolSize, nCandidates);	// Number of candidates (see setCandidatePool)
+	const size_t n        = ((nFeatures < poolSize) ? nFeatures : poolSize);
+	vector<size_t> res(n);
+
+	// Progressive selection : the budget and the cancellation are checked by candidate (the selection stops with the features already selected)
+	atomic<bool> stopped(false);
+	const auto expired = [&]()
+	{
+		if (progress == nullptr) { return false; }
+		if (stopped.load(memory_order_relaxed)) { return true; }
+		if ((progress->cancel != nullptr && progress->cancel->load())
+			|| (progress->budget < numeric_limits<double>::infinity() && chrono::duration<double>(chrono::steady_clock::now() - start).count() > progress->budget)) { stopped = true; }
+		return stopped.load(memory_order_relaxed);
+	};
+
+	// Initialize selection
+	// The selections on subsets run concurrently, they don't use the kept joint counts and the statistics
+	// The mutual infos of a file are looked up if they match the codes (see loadMutualInfos)
+	CMRMRStats* stats = (subset == nullptr) ? m_runStats : nullptr;
+	const bool lookup = subset == nullptr && m_infos.usable;
+	const auto mi     = [&](const size_t variable, const size_t feature, SCountsTable* table)
+	{
+		if (lookup)
+		{
+			const double value = m_infos.value(variable, feature);
+			if (!std::isnan(value)) { return value; }
+		}
+		return (subset == nullptr) ? mutualInfo(variable, feature, table) : mutualInfo(variable, feature, *subset);
+	};
+	CPhaseTimer relevanceTimer(stats, EPhase::Relevance);
+	vector<double> mutualInfos(m_nFeatures);
+	SCountsTable* classTable = (subset == nullptr) ? countsTable(size_t(-1)) : nullptr;	// Joint counts kept in incremental mode
+	const auto byRelevance = [&mutualInfos](const size_t i1, const size_t i2) { return mutualInfos[i1] > mutualInfos[i2]; };
+
+	// Prescreen : the pool is chosen with the relevances approximated on evenly spaced samples
+	double boundary      = -numeric_limits<double>::infinity();	// Relevance of the best feature out of the pool (approximate with the prescreen)
+	const bool prescreen = poolSize < nCandidates && subset == nullptr && m_prescreen != 0 && m_prescreen < m_nSamples && !isSparse();
+	if (prescreen)
+	{
+		vector<size_t> samples(m_prescreen);
+		for (size_t k = 0; k < m_prescreen; ++k) { samples[k] = k * m_nSamples / m_prescreen; }
+		const SSubset approx { &samples, m_classCodes.data(), m_classCounts.size() };
+		if (stats != nullptr) { for (const auto& f : indexes) { recordCall(size_t(-1), f, nullptr); } }
+		pool.parallelFor(m_nFeatures, [&](const size_t begin, const size_t end)
+		{
+			for (size_t i = begin; i < end && !expired(); ++i) { mutualInfos[i] = mutualInfo(size_t(-1), i, approx); }
+		});
+		if (expired()) { return vector<size_t>(); }
+		stable_sort(indexes.begin(), indexes.end(), byRelevance);
+		boundary = mutualInfos[indexes[poolSize]];
+		indexes.resize(poolSize);
+		sort(indexes.begin(), indexes.end());	// The ties of the exact relevances are in the features order as without prescreen
+	}
+
+	// Mutual infos with classId, by blocks of features counted in one sweep (see relevanceBlock)
+	if (stats != nullptr) { for (const auto& f : indexes) { recordCall(size_t(-1), f, classTable); } }
+	const bool sweep = subset == nullptr && !lookup && !isSparse();
+	pool.parallelFor(indexes.size(), [&](const size_t begin, const size_t end)
+	{
+		if (sweep)
+		{
+			for (size_t k = begin; k < end && !expired(); k += RELEVANCE_BLOCK) { relevanceBlock(&indexes[k], min(end, k + RELEVANCE_BLOCK) - k, mutualInfos.data(), classTable); }
+		}
+		else { for (size_t k = begin; k < end && !expired(); ++k) { mutualInfos[indexes[k]] = mi(size_t(-1), indexes[k], classTable); } }
+	});
+	if (expired()) { return vector<size_t>(); }
 	//const double entropy = mutualInfo(size_t(-1), size_t(-1));	// the entropy of target classification variable
 
 	// Sort in Descending Order
-	vector<size_t> indexes(m_nFeatures);
-	iota(indexes.begin(), indexes.end(), 0);
-	stable_sort(indexes.begin(), indexes.end(), [&mutualInfos](const size_t i1, const size_t i2) { return mutualInfos[i1] > mutualInfos[i2]; });
+	stable_sort(indexes.begin(), indexes.end(), byRelevance);
 	//stable_sort(mutualInfos.begin(), mutualInfos.end(), greater<double>()); // Useless
+	if (!prescreen && poolSize < nCandidates)	// Only the pool is scanned by the redundancy phase
+	{
+		boundary = mutualInfos[indexes[poolSize]];
+		indexes.resize(poolSize);
+	}
+	const bool capped = stats != nullptr && poolSize < nCandidates;
 
 
 	//mRMR selection
-	res[0]           = indexes[0];	// We have the first Feature
-	mask[indexes[0]] = false;		// After selection, no longer consider this feature
-	for (size_t i = 1; i < n; ++i)	//the first one, res[0] has been determined already
+	relevanceTimer.stop();
+	CPhaseTimer redundancyTimer(stats, EPhase::Redundancy);
+	vector<double> redundancies(m_nFeatures, 0.0);	// Running sum of the mutual infos with the selected features
+	vector<size_t> counted(m_nFeatures, 0);			// Number of selected features in the running sum (the pruned candidates are late)
+	vector<SCountsTable*> tables;					// Joint counts kept for each selected feature
+	vector<double> scores(m_nFeatures);				// Score of each remaining candidate (in the candidates order)
+	res[0] = indexes[0];							// We have the first Feature
+	indexes.erase(indexes.begin());					// After selection, no longer consider this feature (candidates stay in descending relevance order)
+
+	// Each selected feature is final, it's given to the callback of a progressive selection
+	const auto give = [&](const size_t rank, const double redundancy, const double score)
+	{
+		if (progress == nullptr || !progress->callback) { return true; }
+		return progress->callback({ rank, res[rank], mutualInfos[res[rank]], redundancy, score });
+	};
+	if (capped) { stats->addPoolRound(boundary > mutualInfos[res[0]]); }
+	if (!give(0, 0.0, mutualInfos[res[0]]))
+	{
+		res.resize(1);
+		if (subset == nullptr) { updateWorkingSet(); }
+		return res;
+	}
+
+	// Maximum score of a candidate (redundancy is never negative), it decreases with the candidates order
+	const auto bound = [method](const double relevance)
+	{
+		if (method == EMRMRMethod::MID) { return relevance; }
+		return (relevance > 0) ? relevance / 0.0001 : 0.0;
+	};
+
+	for (size_t i = 1; i < n; ++i)					//the first one, res[0] has been determined already
 	{
+		tables.push_back((subset == nullptr) ? countsTable(res[i - 1]) : nullptr);	// Only the last selected feature is new for the redundancy
 		double score = numeric_limits<double>::min();
-		for (const auto& id : indexes)
-		{
-			if (!mask[id]) { continue; }		// We skeep this Id 
-			const double relevance = mutualInfos[id];
-			double redundancy      = 0;
-			for (size_t j = 0; j < i; ++j) { redundancy += mutualInfo(res[j], id); }
-			redundancy /= double(i);
-			
-			// If more methods, a switch is preferable
-			const double tmp = (method == EMRMRMethod::MID) ? relevance - redundancy : relevance / (redundancy + 0.0001);
-			if (score < tmp)					//update the best feature found and the score
+		const size_t block = m_pruning ? max(size_t(64), 4 * pool.size()) : indexes.size();
+		for (size_t first = 0; first < indexes.size(); first += block)
+		{
+			if (m_pruning && bound(mutualInfos[indexes[first]]) <= score) { break; }	// No remaining candidate can beat the best
+			const size_t last = min(indexes.size(), first + block);
+			if (stats != nullptr)
+			{
+				for (size_t k = first; k < last; ++k) { for (size_t j = counted[indexes[k]]; j < i; ++j) { recordCall(res[j], indexes[k], tables[j]); } }
+			}
+			pool.parallelFor(last - first, [&](const size_t begin, const size_t end)
+			{
+				for (size_t k = first + begin; k < first + end && !expired(); ++k)
+				{
+					const size_t id        = indexes[k];
+					const double relevance = mutualInfos[id];
+					for (size_t j = counted[id]; j < i; ++j) { redundancies[id] += mi(res[j], id, tables[j]); }	// Same summation order than a full recomputation
+					counted[id]             = i;
+					const double redundancy = redundancies[id] / double(i);
+
+					// If more methods, a switch is preferable
+					scores[k] = (method == EMRMRMethod::MID) ? relevance - redundancy : relevance / (redundancy + 0.0001);
+				}
+			});
+
+			// Sequential reduction in candidates order, so ties are broken as a sequential scan
+			for (size_t k = first; k < last; ++k)
 			{
-				score  = tmp;
-				res[i] = id;
+				if (score < scores[k])				//update the best feature found and the score
+				{
+					score  = scores[k];
+					res[i] = indexes[k];
+				}
 			}
 		}
-		// Remove from the id list the final selection with the mask,  we can remove index from indexes vector instead of use mask 
-		// (a test can be make to find wich method of mask and vector modification is faster)
-		mask[res[i]] = false;
+		if (expired())	// The round is not complete
+		{
+			res.resize(i);
+			break;
+		}
+
+		// Remove from the id list the final selection
+		const auto it = find(indexes.begin(), indexes.end(), res[i]);
+		if (it != indexes.end()) { indexes.erase(it); }
+		const bool found = score != numeric_limits<double>::min();	// Otherwise the feature keeps its initial index
+		if (capped) { stats->addPoolRound(!found || bound(boundary) > score); }	// With MIQ, the bound is loose and almost every round is a risk
+		if (!give(i, found ? redundancies[res[i]] / double(i) : numeric_limits<double>::quiet_NaN(), found ? score : numeric_limits<double>::quiet_NaN()))
+		{
+			res.resize(i + 1);
+			break;
+		}
 	}
+	if (subset == nullptr) { updateWorkingSet(); }
 	return res;
 }
 ///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::recordCall(const size_t variable, const size_t feature, const SCountsTable* table) const
+{
+	const size_t n1     = (variable == size_t(-1)) ? m_nClassStates : m_nStates[variable];
+	const bool relevant = variable == size_t(-1);
+	const bool cached   = (table != nullptr && table->valid[feature]) || (m_infos.usable && !std::isnan(m_infos.value(variable, feature)));
+	m_runStats->addHistogram(n1 * m_nStates[feature]);
+	m_runStats->addCalls(relevant ? 1 : 0, relevant ? 0 : 1, cached ? 1 : 0);
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMRMR::updateWorkingSet() const
+{
+	if (m_runStats == nullptr) { return; }
+	uint64_t bytes = (m_mappedDatas != nullptr) ? m_nFeatures * m_nSamples * sizeof(double) : m_datas.capacity() * sizeof(double) + m_floatDatas.capacity() * sizeof(float);
+	bytes += (m_mappedCodes != nullptr) ? m_nFeatures * m_nEncoded * sizeof(code_t) : m_codes.capacity() * sizeof(code_t);
+	bytes += m_sparseOffsets.capacity() * sizeof(size_t) + m_sparseRows.capacity() * sizeof(uint32_t) + m_sparseValues.capacity() * sizeof(double);
+	bytes += m_sparseCodeRows.capacity() * sizeof(uint32_t) + m_sparseCodes.capacity() * sizeof(code_t);
+	bytes += (m_planes.capacity() + m_classPlanes.capacity()) * sizeof(uint64_t) + m_nFeatures * sizeof(SFeatureStats);
+	for (const auto& t : m_tables) { bytes += t.second.counts.capacity() * sizeof(uint32_t) + m_nFeatures * (sizeof(size_t) + 1); }
+	bytes += m_nFeatures * (3 * sizeof(double) + sizeof(size_t));	// Relevance, redundancies, scores and candidates of the selection
+	if (m_infos.file != nullptr) { bytes += m_infos.file->size(); }
+	m_runStats->setWorkingSet(bytes);
+}
+///-------------------------------------------------------------------------------------------------
@@ -19,9 +19,38 @@
 #include <sstream>
 #include <map>
 #include <limits>
+#include <cstdint>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
 enum class EMRMRMethod { MID, MIQ };
 
+/// <summary> Binning of the features for the continuous path (infinite threshold). </summary>
+/// - Round : the values are rounded (one state by integer, the number of states depends on the range of the values).
+/// - EqualWidth : the range of the values is split in bins of the same width.
+/// - EqualFrequency : the bins contain the same number of samples (the edges are the quantiles of the feature).
+enum class EBinning { Round, EqualWidth, EqualFrequency };
+
+/// <summary> Format of the sparse datas (see <see cref="CMRMR::setSparseDatas"/>). </summary>
+/// - CSR : compressed sparse rows, the non-zero values are grouped by sample (offsets of each sample, feature of each value).
+/// - CSC : compressed sparse columns, the non-zero values are grouped by feature (offsets of each feature, sample of each value).
+enum class ESparseFormat { CSR, CSC };
+
+/// <summary> Precision of the raw values kept in memory (see <see cref="CMRMR::setPrecision"/>). </summary>
+/// - Double : the values are kept as given (8 bytes by value).
+/// - Float : the values are rounded to single precision (4 bytes by value), the statistics and the encoding are computed in double on the rounded values.
+enum class EPrecision { Double, Float };
+
+class CThreadPool;
+class CMappedFile;
+class CMRMRStats;
+class CSocket;
+
 class CMRMR
 {
 public:	
@@ -39,9 +68,59 @@ public:
 	std::string print() const;
 	
 	/// <summary>Reads the CSV file (with example format in http://home.penglab.com/proj/mRMR/ website). </summary>
+	/// The file is memory mapped and split in line aligned chunks parsed in parallel (without locale) directly in the datas matrix.
 	/// <param name="filename">The filename.</param>
+	/// <param name="nThreads"> The number of threads used to parse the file (0 to use all hardware threads). </param>
+	/// <returns> True if Succes, False if Fail (the datas are reset). </returns>
+	bool readCSV(const std::string& filename, const size_t nThreads = 1);
+
+	/// <summary> Save the datas in a binary file. </summary>
+	/// The file contains the raw datas in column major order, the class of each sample and the encoded features if <see cref="process"/> has been called (see <see cref="SFileHeader"/>).
+	/// <param name="filename">The filename.</param>
+	/// <returns> True if Succes, False if Fail. </returns>
+	bool save(const std::string& filename) const;
+
+	/// <summary> Load a binary file created with <see cref="save"/>. </summary>
+	/// The file is memory mapped and the datas (and encoded features) are used in place without copy, the pages are shared between processes which load the same file.\n
+	/// If the file contains encoded features, <see cref="process"/> with the same threshold doesn't encode again.
+	/// <param name="filename">The filename.</param>
+	/// <returns> True if Succes, False if Fail. </returns>
+	bool load(const std::string& filename);
+
+	/// <summary> Compute the mutual infos between the features and save them in a binary file, to be reused by other selections on the same encoded datas (see <see cref="loadMutualInfos"/>). </summary>
+	/// The relevances of all features are saved in double. The mutual infos between two features are computed in parallel by blocks of features (the codes of two blocks stay in cache)
+	/// and written in place in the memory mapped file.
+	/// - Double : the square matrix of the mutual infos in the two orders, the selection is the same as <see cref="process"/>.
+	/// - Float : the upper triangle in single precision (4 times smaller for the same features), the scores are rounded so close candidates can be swapped.
+	/// With top, only the mutual infos between the top features by relevance are saved (the other ones are computed by the selection).
+	/// The file contains a fingerprint of the codes and of the classes. Sparse datas are not supported.
+	/// <param name="filename">The filename.</param>
+	/// <param name="threshold">The threshold for discretization (if infinity we only use z-score).</param>
+	/// <param name="precision">The precision and the layout of the mutual infos.</param>
+	/// <param name="top">The number of features of the matrix (0 for all features).</param>
+	/// <param name="nThreads"> The number of threads used to encode the features and to compute the mutual infos (0 to use all hardware threads). </param>
 	/// <returns> True if Succes, False if Fail. </returns>
-	bool readCSV(const std::string& filename);
+	bool saveMutualInfos(const std::string& filename, const double threshold, const EPrecision precision = EPrecision::Double, const size_t top = 0, const size_t nThreads = 1);
+
+	/// <summary> Map a file of mutual infos created by <see cref="saveMutualInfos"/> (on these datas or on a copy of them). </summary>
+	/// The next selections look up the relevances and the mutual infos in the file instead of computing them if the codes have the fingerprint of the file
+	/// (same datas, threshold and binning), otherwise they are computed as usual. The pages are shared between processes which map the same file.
+	/// The file is released when the datas are reset.
+	/// <param name="filename">The filename.</param>
+	/// <returns> True if Succes, False if Fail (not a file of mutual infos or not the same number of features and samples). </returns>
+	bool loadMutualInfos(const std::string& filename);
+
+	/// <summary> Reads the CSV file in streaming mode, for datas bigger than the memory. </summary>
+	/// The raw datas are never kept in memory, only the codes for this threshold are kept in a memory mapped scratch file (one byte by value).\n
+	/// -# The first pass computes the statistics of each feature (see <see cref="SFeatureStats"/>).
+	/// -# The second pass writes the codes of each feature in the scratch file.\n
+	/// The file is read by blocks of lines, so the memory used doesn't depend on the number of samples. Only <see cref="process"/> with the same threshold is possible after.
+	/// <param name="filename">The filename.</param>
+	/// <param name="threshold">The threshold for discretization (if infinity we only use z-score).</param>
+	/// <param name="scratch">The filename of the scratch file (removed when the datas are reset).</param>
+	/// <param name="nThreads"> The number of threads used to parse and encode the file (0 to use all hardware threads). </param>
+	/// <returns> True if Succes, False if Fail (the datas are reset). </returns>
+	bool streamCSV(const std::string& filename, const double threshold, const std::string& scratch, const size_t nThreads = 1);
 
 	/// <summary> Reset previous datas and set this datas. </summary>
 	/// <param name="datas">The datas.</param>
@@ -60,13 +139,187 @@ public:
 	/// <param name="classId">The classes of this sample.</param>
 	/// <returns> True if success, False if fail (not same number feature than previous datas). </returns>
 	bool addSample(const std::vector<double>& sample, const int classId);
+
+	/// <summary> Append feature columns to the datas (same samples). </summary>
+	/// The encoding of a feature only depends on its values, so the codes and the bit planes of the previous features are kept and the next <see cref="process"/> with the same threshold
+	/// only encodes the new columns. In incremental mode (see <see cref="setIncremental"/>), the kept joint counts of the previous features (relevances and mutual infos with the selected features)
+	/// are reused by the selection, only the mutual infos with the new features are computed. The result is the same than a process on a new object with all the columns.
+	/// <param name="columns">The values of each new feature (one value by sample).</param>
+	/// <returns> True if success, False if fail (no samples, not same number of samples, sparse datas or raw datas not available). </returns>
+	bool addFeatures(const std::vector<std::vector<double>>& columns);
+
+	/// <summary> Reset previous datas and set sparse datas (only the non-zero values are kept). </summary>
+	/// The datas are kept by feature (CSC) and only the values whose state is not the state of 0 are encoded, so the memory and the mutual infos depend on the number of non-zero values.\n
+	/// The joint counts of the mutual infos are built with the non-zero values, the count of the two zero states is deduced from the number of samples.
+	/// The selection is the same as the dense datas with an infinite threshold or a threshold of 0 (with another threshold, the variance of the z-score is computed in another order).\n
+	/// The samples can't be added after, and the sparse datas can't be saved or used by <see cref="stability"/>.
+	/// <param name="format">The format of the datas.</param>
+	/// <param name="nFeatures">The number of features (for the CSR format, with CSC it must be the number of offsets - 1).</param>
+	/// <param name="offsets">The first value of each sample (CSR) or of each feature (CSC), and the number of values at the end.</param>
+	/// <param name="indexes">The feature (CSR) or the sample (CSC) of each value (sorted in each sample or feature).</param>
+	/// <param name="values">The values.</param>
+	/// <param name="classes">The classes of each sample.</param>
+	/// <returns> True if success, False if fail (sizes or indexes are not valid). </returns>
+	bool setSparseDatas(const ESparseFormat format, const size_t nFeatures, const std::vector<size_t>& offsets, const std::vector<size_t>& indexes,
+						const std::vector<double>& values, const std::vector<int>& classes);
+
+	/// <summary> Enable the statistics of the reading and the selection (timings of each phase, mutual infos, histograms and working set, see <see cref="CMRMRStats"/>). </summary>
+	/// The statistics are accumulated in the object until it is reset, the object must exist while it is used. Without object, nothing is measured.
+	/// <param name="stats">The statistics to fill (nullptr to disable).</param>
+	void setStats(CMRMRStats* stats);
+
+	/// <summary> Enable or disable the pruned search of the candidates. </summary>
+	/// The redundancy is never negative (the mutual infos are clamped at 0), so the score of a candidate is bounded by its relevance (MID) or its relevance divided by \f$ 10^{-4} \f$ (MIQ).
+	/// The candidates are sorted by descending relevance, so the scan of a round stops when the bound of the next candidates can't beat the best score.
+	/// The redundancy of a skipped candidate is completed when it is evaluated again, so the selection is the same than without pruning.
+	/// <param name="pruning">True to stop the scan of the candidates with the bound.</param>
+	void setPruning(const bool pruning);
+
+	/// <summary> Limit the redundancy search to a pool of the most relevant features (as the original tool). </summary>
+	/// The candidates of the selection are the size features with the best relevance, so the redundancy phase depends on the size of the pool instead of the number of features
+	/// and at most size features are selected. The rounds where a feature out of the pool could beat the selected feature are counted in the statistics
+	/// (an upper bound of the rounds changed by the pool, only meaningful with MID, see <see cref="CMRMRStats::boundaryRiskRounds"/>).
+	/// With the prescreen, the relevances are first approximated on evenly spaced samples and the exact relevances are only computed for the pool (the pool can differ from the exact one).
+	/// The pool is not used by <see cref="serve"/>, and the prescreen is not used by <see cref="stability"/> and with sparse datas.
+	/// <param name="size">The size of the pool (0 to use all features).</param>
+	/// <param name="prescreen">The number of samples of the prescreen (0 or more than the number of samples to compute all exact relevances).</param>
+	void setCandidatePool(const size_t size, const size_t prescreen = 0);
+
+	/// <summary> Set the binning of the features used by <see cref="process"/> with an infinite threshold. </summary>
+	/// With EqualWidth or EqualFrequency, each feature has at most nBins states whatever the distribution of the values (the rounding can create hundreds of states with one outlier).
+	/// The EqualFrequency binning needs all the values of a feature, so it can't be used by <see cref="streamCSV"/>.
+	/// <param name="binning">The binning.</param>
+	/// <param name="nBins">The number of bins (ignored with Round, 1 to 256).</param>
+	/// <returns> True if success, False if fail (bad number of bins). </returns>
+	bool setBinning(const EBinning binning, const size_t nBins = 16);
+
+	/// <summary> Set the precision of the raw values kept in memory (the values read or set after, and the current raw datas which are converted). </summary>
+	/// With Float, the memory of the raw datas is halved and the selection is the same as the datas rounded to single precision with Double.
+	/// The binary files keep the values in double (a loaded file is used in place in double until the datas are modified).
+	/// <param name="precision">The precision.</param>
+	void setPrecision(const EPrecision precision);
+
+	/// <summary> Enable or disable the release of the raw datas after the encoding. </summary>
+	/// When enabled, the raw datas are freed once <see cref="process"/> has encoded the features, only the codes (one byte by value) are kept.
+	/// As in streaming mode, only the same threshold can be processed after and the samples can't be added (the sparse datas are kept).
+	/// <param name="release">True to release the raw datas after the encoding.</param>
+	void setReleaseDatas(const bool release);
+
+	/// <summary> Enable or disable the incremental mode. </summary>
+	/// In incremental mode, the statistics of each feature are updated by <see cref="addSample"/> and the joint counts of the mutual infos computed by <see cref="process"/> are kept.
+	/// The next <see cref="process"/> with the same threshold encodes the new samples and only updates the joint counts with the samples whose state changes (a mutual info is computed again only if the states of a feature are shifted).
+	/// The result is the same than a process on a new object with the same datas.
+	/// <param name="incremental">True to keep the joint counts, False to release them.</param>
+	void setIncremental(const bool incremental);
 	
 	/// <summary> Apply the mRMR algorithm after compute zscore and discretisation. </summary>
+	/// A feature is encoded with at most 256 states (one byte by value). With an infinite threshold and the rounding, a feature with a wider range of states is ignored :
+	/// it's never selected and the selection can have less than nFeatures features (an equal width or equal frequency binning keeps all features, see <see cref="setBinning"/>).
 	/// <param name="threshold">The threshold for discretization (if infinity we only use z-score).</param>
 	/// <param name="nFeatures"> The number of features to keep. Default 500 is the original theorical max of the method (not needed but a wink to the origin). </param>
 	/// <param name="method"> Method Used for mRMR. </param>
+	/// <param name="nThreads"> The number of threads used to encode and score the features (0 to use all hardware threads). The result doesn't depend of this number. </param>
 	/// <returns></returns>
-	std::vector<size_t> process(const double threshold = std::numeric_limits<double>::infinity(), const size_t nFeatures = 500, const EMRMRMethod method = EMRMRMethod::MID);
+	std::vector<size_t> process(const double threshold = std::numeric_limits<double>::infinity(), const size_t nFeatures = 500, const EMRMRMethod method = EMRMRMethod::MID,
+								const size_t nThreads = 1);
+
+	/// <summary> Feature selected by <see cref="processProgressive"/>. </summary>
+	struct SSelected
+	{
+		size_t rank       = 0;	// Rank in the selection (0 for the first selected feature)
+		size_t feature    = 0;	// Index of the feature
+		double relevance  = 0;	// Mutual info with the classification target
+		double redundancy = 0;	// Mean of the mutual infos with the previous selected features (0 for the first, NaN if no candidate beats the initial score)
+		double score      = 0;	// Score of the method (relevance for the first, NaN if no candidate beats the initial score)
+	};
+
+	/// <summary> Control of <see cref="processProgressive"/>. </summary>
+	struct SProgress
+	{
+		std::function<bool(const SSelected&)> callback;					// Called for each selected feature in selection order, return false to stop (can be empty)
+		double budget                   = std::numeric_limits<double>::infinity();	// Wall-clock budget in seconds, from the call (encoding included)
+		const std::atomic<bool>* cancel = nullptr;										// The selection stops when this flag is set (by another thread or by the callback)
+	};
+
+	/// <summary> Apply the mRMR algorithm and give the selected features one by one. </summary>
+	/// The selection is greedy, so each selected feature is final when it's given and the selection stopped after K features is the prefix of <see cref="process"/>.\n
+	/// The budget and the cancellation flag are checked between the candidates (the relevance and the redundancy phases are interrupted, the encoding isn't),
+	/// the features selected before the stop are kept.
+	/// <param name="progress">The callback, the budget and the cancellation flag.</param>
+	/// <param name="threshold">The threshold for discretization (if infinity we only use z-score).</param>
+	/// <param name="nFeatures"> The number of features to keep. </param>
+	/// <param name="method"> Method Used for mRMR. </param>
+	/// <param name="nThreads"> The number of threads used to encode and score the features (0 to use all hardware threads). </param>
+	/// <returns> The features selected before the end of the budget, the cancellation or the stop of the callback. </returns>
+	std::vector<size_t> processProgressive(const SProgress& progress, const double threshold = std::numeric_limits<double>::infinity(), const size_t nFeatures = 500,
+										   const EMRMRMethod method = EMRMRMethod::MID, const size_t nThreads = 1);
+
+	/// <summary> Configuration of a selection for <see cref="processBatch"/>. </summary>
+	struct SProcessConfig
+	{
+		double threshold   = std::numeric_limits<double>::infinity();	// The threshold for discretization (if infinity we only use z-score)
+		size_t nFeatures   = 500;										// The number of features to keep
+		EMRMRMethod method = EMRMRMethod::MID;							// Method Used for mRMR
+	};
+
+	/// <summary> Apply the mRMR algorithm for several configurations on the same datas. </summary>
+	/// -# The features are encoded once by threshold.
+	/// -# The joint counts of the mutual infos are kept during the batch (as in incremental mode, see <see cref="setIncremental"/>), so the relevance and the mutual infos between two features are counted once for all methods.
+	/// -# The selection is greedy, so the selection of K features is the prefix of the selection of more features, only the biggest K of a threshold and a method is processed.
+	/// <param name="configs">The configurations.</param>
+	/// <param name="nThreads"> The number of threads used to encode and score the features (0 to use all hardware threads). </param>
+	/// <returns> The selection of each configuration (same as <see cref="process"/>, empty if the features can't be encoded with the threshold). </returns>
+	std::vector<std::vector<size_t>> processBatch(const std::vector<SProcessConfig>& configs, const size_t nThreads = 1);
+
+	/// <summary> Selections of <see cref="stability"/>. </summary>
+	struct SStability
+	{
+		std::vector<std::vector<size_t>> selections;	// Selection of each subset
+		std::vector<double> frequencies;				// Frequency of each feature in the selections (in [0, 1])
+	};
+
+	/// <summary> Apply the mRMR algorithm on subsets of the samples (bootstrap, cross validation...) for a stability selection. </summary>
+	/// The features are encoded once with all the samples, then the subsets are selected concurrently on the shared codes through their sample indexes (without copy of the datas).
+	/// A sample can be several times in a subset (bootstrap). With an infinite threshold and the rounding, the selection of a subset is the same as <see cref="process"/> on a copy of its samples,
+	/// with a finite threshold the z-score uses the statistics of all the samples.
+	/// The frequencies are computed on the non-empty selections and don't count the padding of the rounds where no candidate beats the initial score.
+	/// <param name="subsets">The sample indexes of each subset.</param>
+	/// <param name="threshold">The threshold for discretization (if infinity we only use z-score).</param>
+	/// <param name="nFeatures"> The number of features to keep by subset. </param>
+	/// <param name="method"> Method Used for mRMR. </param>
+	/// <param name="nThreads"> The number of threads used to encode the features and to select the subsets (0 to use all hardware threads). </param>
+	/// <returns> The selection of each subset and the frequency of each feature (empty if a sample index is not in the datas, the features can't be encoded or all selections are empty). </returns>
+	SStability stability(const std::vector<std::vector<size_t>>& subsets, const double threshold, const size_t nFeatures, const EMRMRMethod method = EMRMRMethod::MID,
+						 const size_t nThreads = 1);
+
+	/// <summary> Serve a shard of the features to a coordinator (see <see cref="processSharded"/>). </summary>
+	/// The object contains the columns of its shard and the classes of all samples. For each selection, the shard encodes its features, sends its best candidate by relevance,
+	/// then for each selected feature it receives the column of the feature (or sends it if the feature is in the shard), updates the redundancy of its candidates and sends its best candidate.\n
+	/// The function returns when the coordinator stops the session. Sparse datas can't be served.
+	/// <param name="listener">The listening socket (see <see cref="CSocket::listen"/>), one coordinator is accepted.</param>
+	/// <param name="nThreads"> The number of threads used to encode and score the features of the shard (0 to use all hardware threads). </param>
+	/// <returns> True if success, False if fail (connection lost or sparse datas). </returns>
+	bool serve(const CSocket& listener, const size_t nThreads = 1);
+
+	/// <summary> Serve a shard of the features to a coordinator on a port (see <see cref="serve(const CSocket&, const size_t)"/>). </summary>
+	/// <param name="port">The port.</param>
+	/// <param name="nThreads"> The number of threads used to encode and score the features of the shard (0 to use all hardware threads). </param>
+	/// <returns> True if success, False if fail (port not available, connection lost or sparse datas). </returns>
+	bool serve(const uint16_t port, const size_t nThreads = 1);
+
+	/// <summary> Apply the mRMR algorithm on features split in shards served by other processes (see <see cref="serve"/>). </summary>
+	/// The features of the shards are numbered in the order of the workers, the coordinator drives the greedy loop and keeps no datas :
+	/// -# Each worker sends its best candidate, the global winner is the best score (ties are broken by descending relevance then ascending index as in a single process).
+	/// -# The column of the winner is sent by its worker to the others, which add its mutual info to the redundancy of their candidates.\n
+	/// The mutual infos are computed with the same joint counts and summed in the same order as <see cref="process"/>, so the selection is the same as a single process on all the features.
+	/// The workers must use the same binning and the same binary representation (endianness).
+	/// <param name="workers">The host and the port of each worker.</param>
+	/// <param name="threshold">The threshold for discretization (if infinity we only use z-score).</param>
+	/// <param name="nFeatures"> The number of features to keep. </param>
+	/// <param name="method"> Method Used for mRMR. </param>
+	/// <returns> The selected indexes (empty if a worker can't be reached or can't encode its features, or if the workers don't have the same samples). </returns>
+	static std::vector<size_t> processSharded(const std::vector<std::pair<std::string, uint16_t>>& workers, const double threshold, const size_t nFeatures,
+											  const EMRMRMethod method = EMRMRMethod::MID);
 
 	/// <summary>	Override the ostream operator. </summary>
 	/// <param name="os">	The ostream. </param>
@@ -76,31 +329,318 @@ public:
 
 
 private:
+	typedef uint8_t code_t;							// Type of an encoded state
+
+	static constexpr uint64_t ALIGNMENT  = 64;			// Alignment of the sections of the binary file
+	static constexpr size_t STREAM_BLOCK = 64 << 20;	// Size in bytes of the raw values parsed at once in streaming mode
+	static constexpr size_t RELEVANCE_BLOCK = 256;		// Number of features whose relevance is counted in one sweep (see relevanceBlock)
+
+	/// <summary> Header of the binary file, all sections are aligned on <see cref="ALIGNMENT"/> bytes. </summary>
+	struct SFileHeader
+	{
+		char magic[8]       = { 'M', 'R', 'M', 'R', 'B', 'I', 'N', '\0' };	// File signature
+		uint32_t version    = 2;											// Format version
+		uint32_t endianness = 0x01020304;									// To check the endianness
+		uint64_t nFeatures  = 0;											// Number of Features
+		uint64_t nSamples   = 0;											// Number of Samples
+		double threshold    = 0;											// Threshold used for the codes
+		uint32_t binning    = 0;											// Binning used for the codes (see EBinning)
+		uint32_t nBins      = 0;											// Number of bins used for the codes
+		uint64_t classes    = 0;											// Offset of the class of each sample (int32)
+		uint64_t datas      = 0;											// Offset of the raw datas (double, feature -> samples)
+		uint64_t states     = 0;											// Offset of the number of states of each feature (uint64, 0 if no codes)
+		uint64_t codes      = 0;											// Offset of the codes (feature -> samples, 0 if no codes)
+	};
+
+	/// <summary> Header of the file of mutual infos (see <see cref="saveMutualInfos"/>), all sections are aligned on <see cref="ALIGNMENT"/> bytes. </summary>
+	struct SInfosHeader
+	{
+		char magic[8]        = { 'M', 'R', 'M', 'R', 'M', 'I', 'S', '\0' };	// File signature
+		uint32_t version     = 1;											// Format version
+		uint32_t endianness  = 0x01020304;									// To check the endianness
+		uint64_t fingerprint = 0;											// Fingerprint of the codes and the classes
+		uint64_t nFeatures   = 0;											// Number of Features
+		uint64_t nSamples    = 0;											// Number of Samples
+		uint64_t nMatrix     = 0;											// Number of features of the matrix
+		uint32_t precision   = 0;											// Precision and layout of the matrix (see EPrecision)
+		uint32_t reserved    = 0;											// Padding
+		uint64_t relevances  = 0;											// Offset of the relevance of each feature (double)
+		uint64_t features    = 0;											// Offset of the features of the matrix (uint64, ascending)
+		uint64_t infos       = 0;											// Offset of the mutual infos (double square or float upper triangle)
+	};
+
+	/// <summary> Align an offset of the binary file. </summary>
+	static uint64_t alignOffset(const uint64_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
 	size_t m_nFeatures = 0;							// Number of Features
 	size_t m_nSamples  = 0;							// Number of Samples
 	std::map<int, std::vector<size_t>> m_classes;	// Datas in the format class -> vector id sample
-	std::vector<std::vector<double>> m_datas;		// Datas in the format sample -> features
-	std::vector<std::vector<double>> m_discretized;	// Datas in the format sample -> features discretized (z-score or z-score + discretization)
+	size_t m_stride    = 0;							// Number of samples allocated for each feature in m_datas
+	std::vector<double> m_datas;					// Datas in the format feature -> samples (column major, m_stride samples by feature)
+	std::vector<float> m_floatDatas;				// Datas in single precision (used instead of m_datas with EPrecision::Float)
+	EPrecision m_precision = EPrecision::Double;	// Precision of the owned raw datas
+	bool m_releaseDatas    = false;					// Release the raw datas after the encoding (see setReleaseDatas)
+	EBinning m_binning = EBinning::Round;			// Binning used with an infinite threshold
+	size_t m_nBins     = 16;						// Number of bins of the binning
+	std::vector<size_t> m_sparseOffsets;			// Sparse datas : first value of each feature and number of values (empty if the datas are dense)
+	std::vector<uint32_t> m_sparseRows;				// Sparse datas : sample of each value (sorted by feature then by sample)
+	std::vector<double> m_sparseValues;				// Sparse datas : non-zero values
+	std::vector<code_t> m_codes;					// Datas in the format feature -> samples discretized (z-score or z-score + discretization) and encoded in [0, n states[
+	double m_codesThreshold = std::numeric_limits<double>::quiet_NaN();	// Threshold used to compute the codes (NaN if no codes)
+	EBinning m_codesBinning = EBinning::Round;		// Binning used to compute the codes (with an infinite threshold)
+	size_t m_codesBins      = 0;					// Number of bins used to compute the codes
+	std::shared_ptr<CMappedFile> m_file;			// Binary file mapped by load (shared by the copies of this object)
+	const double* m_mappedDatas = nullptr;			// Datas used in place in the binary file (nullptr if datas are in m_datas)
+	const code_t* m_mappedCodes = nullptr;			// Codes used in place in the binary file (nullptr if codes are in m_codes)
+	size_t m_nEncoded = 0;							// Number of samples encoded in the codes (less than m_nSamples if samples are added after)
+	std::vector<size_t> m_nStates;					// Number of states of each encoded feature
+	std::vector<code_t> m_zeroCodes;				// Sparse datas : state of the value 0 of each feature
+	std::vector<size_t> m_sparseCodeCounts;			// Sparse datas : number of encoded values of each feature (stored at the offsets of the raw values)
+	std::vector<uint32_t> m_sparseCodeRows;			// Sparse datas : sample of each encoded value (only the values whose state is not the state of 0)
+	std::vector<code_t> m_sparseCodes;				// Sparse datas : state of each encoded value
+	std::vector<int> m_minStates;					// First state of each encoded feature (before the shift in [0, n states[)
+	std::vector<uint8_t> m_ignored;					// Features with too many states (encoded in a single state, never selected)
+	int m_minClass        = 0;						// First class of the encoded datas
+	size_t m_nClassStates = 0;						// Number of states of the classification target of the encoded datas
+	std::vector<uint64_t> m_planes;					// Bit planes of the features with few states (see MutualInfo::MAX_BIT_STATES)
+	std::vector<size_t> m_planeCounts;				// Number of samples in each bit plane
+	std::vector<size_t> m_planeIdx;					// Index of the first bit plane of each feature (size_t(-1) if the feature has too many states)
+	std::vector<int> m_classCodes;					// Class state of each sample (computed once by process, see encodeClasses)
+	std::vector<size_t> m_classCounts;				// Number of samples of each class state (marginal counts of the classification target)
+	std::vector<uint64_t> m_classPlanes;			// Bit planes of the classification target (empty if too many states)
+
+	/// <summary> Joint counts of a variable with each feature, kept between two <see cref="process"/> in incremental mode. </summary>
+	struct SCountsTable
+	{
+		std::vector<uint32_t> counts;	// Joint counts of the variable with each feature (n states of the variable x n states of the feature)
+		std::vector<size_t> offsets;	// Offset of the joint counts of each feature
+		std::vector<uint8_t> valid;		// The joint counts of the feature are computed
+	};
+
+	CMRMRStats* m_runStats = nullptr;				// Statistics to fill (nullptr if disabled)
+	bool m_pruning         = false;					// Stop the scan of the candidates with the bound of the score (see setPruning)
+	size_t m_poolSize      = 0;						// Number of candidates of the selection (0 for all features, see setCandidatePool)
+	size_t m_prescreen     = 0;						// Number of samples used to approximate the relevances before the pool (0 if disabled)
+	bool m_incremental     = false;					// Keep the statistics and the joint counts (see setIncremental)
+	std::map<size_t, SCountsTable> m_tables;		// Joint counts of each variable (size_t(-1) for the classification target)
 
+	/// <summary> Mutual infos mapped by <see cref="loadMutualInfos"/>. </summary>
+	struct SInfosMatrix
+	{
+		std::shared_ptr<CMappedFile> file;	// Mapped file (nullptr if no file)
+		uint64_t fingerprint = 0;			// Fingerprint of the codes of the file
+		size_t n             = 0;			// Number of features of the matrix
+		bool single          = false;		// Float upper triangle (double square otherwise)
+		const double* relevances = nullptr;	// Relevance of each feature
+		const void* infos        = nullptr;	// Mutual infos between the features of the matrix
+		std::vector<size_t> positions;		// Position of each feature in the matrix (size_t(-1) if not in the matrix)
+		bool usable = false;				// The file matches the current codes (checked by prepare)
+
+		/// <summary> Look up a mutual info. </summary>
+		/// <param name="variable">The variable (size_t(-1) for the classification target).</param>
+		/// <param name="feature">The feature.</param>
+		/// <returns> The mutual info (NaN if it's not in the file). </returns>
+		double value(const size_t variable, const size_t feature) const;
+	};
+
+	SInfosMatrix m_infos;							// Mutual infos of a file (see loadMutualInfos)
+	mutable uint64_t m_fingerprint = 0;				// Fingerprint of the current codes (0 if not computed)
+
+	/// <summary> Compute the fingerprint of the codes and of the classes (kept until the codes change). </summary>
+	/// <returns> The fingerprint. </returns>
+	uint64_t fingerprint() const;
 
 	std::vector<int> class2IdxVector(size_t& n) const;
-	std::vector<int> discret2IdxVector(const size_t feature, size_t& n) const;
+
+	/// <summary> Get the raw values of a feature. </summary>
+	/// <param name="feature">The feature.</param>
+	/// <returns> The contiguous column of the feature (one value by sample). </returns>
+	const double* rawColumn(const size_t feature) const { return (m_mappedDatas != nullptr ? m_mappedDatas : m_datas.data()) + feature * m_stride; }
+
+	/// <summary> Check if the raw datas are in single precision (see <see cref="setPrecision"/>). </summary>
+	/// <returns> True if the owned raw datas are floats. </returns>
+	bool isFloat() const { return m_mappedDatas == nullptr && m_precision == EPrecision::Float; }
+
+	/// <summary> Call a function with the raw values of a feature. </summary>
+	/// <param name="feature">The feature.</param>
+	/// <param name="func">The function called with the contiguous column of the feature (const double* or const float* in single precision).</param>
+	template <typename F>
+	void withRawColumn(const size_t feature, F&& func) const
+	{
+		if (isFloat()) { func(m_floatDatas.data() + feature * m_stride); }
+		else { func(rawColumn(feature)); }
+	}
+
+	/// <summary> Resize the owned raw datas (in the current precision). </summary>
+	/// <param name="size">The number of values.</param>
+	void resizeDatas(const size_t size)
+	{
+		if (m_precision == EPrecision::Float) { m_floatDatas.resize(size); }
+		else { m_datas.resize(size); }
+	}
+
+	/// <summary> Check if the raw datas are available (not in streaming mode or released). </summary>
+	/// <returns> True if the raw datas are available. </returns>
+	bool hasRawDatas() const
+	{
+		return !isSparse() && (m_mappedDatas != nullptr || (isFloat() ? m_floatDatas.size() : m_datas.size()) == m_nFeatures * m_stride);
+	}
+
+	/// <summary> Free the raw datas (the codes are kept, see <see cref="setReleaseDatas"/>). </summary>
+	void releaseDatas();
+
+	/// <summary> Check if the datas are sparse (see <see cref="setSparseDatas"/>). </summary>
+	/// <returns> True if the datas are sparse. </returns>
+	bool isSparse() const { return !m_sparseOffsets.empty(); }
+
+	/// <summary> Reserve the datas matrix for a number of samples (the columns are moved if needed). </summary>
+	/// <param name="nSamples">The number of samples.</param>
+	void reserve(const size_t nSamples);
+
+	/// <summary> Copy the raw datas in owned datas with a stride and a precision (the columns of a mapped file are copied). </summary>
+	/// <param name="stride">The number of samples allocated for each feature.</param>
+	/// <param name="precision">The precision of the owned datas.</param>
+	void convertDatas(const size_t stride, const EPrecision precision);
+
+	/// <summary> Get the encoded states of a feature. </summary>
+	/// <param name="feature">The feature.</param>
+	/// <returns> The contiguous column of the feature (one state by sample). </returns>
+	const code_t* column(const size_t feature) const { return (m_mappedCodes != nullptr ? m_mappedCodes : m_codes.data()) + feature * m_nEncoded; }
+
+	/// <summary> Check if the features are encoded. </summary>
+	/// <returns> True if the codes are available for all samples. </returns>
+	bool hasCodes() const { return !std::isnan(m_codesThreshold) && m_nEncoded == m_nSamples && m_nStates.size() == m_nFeatures; }
+
+	/// <summary> Encode the features for this threshold (if they are not already encoded with it) and build the bit planes. </summary>
+	/// <param name="threshold">The threshold for discretization (if infinity we only use z-score).</param>
+	/// <param name="pool">The thread pool used to encode the features.</param>
+	/// <returns> True if success, False if fail (a feature can't be encoded). </returns>
+	bool prepare(const double threshold, CThreadPool& pool);
+
+	/// <summary> Encode the samples added since the last encoding and update the kept joint counts. </summary>
+	/// The statistics of the features change with the new samples, so all samples are encoded again, the joint counts are updated with the old samples whose state change and with the new samples.
+	/// The joint counts of a feature whose first state or number of states change are removed.
+	/// <param name="threshold">The threshold for discretization.</param>
+	/// <param name="pool">The thread pool used to encode the features.</param>
+	/// <returns> True if success, False if fail (a feature can't be encoded). </returns>
+	bool updateCodes(const double threshold, CThreadPool& pool);
+
+	/// <summary> Encode the features appended since the last encoding (see <see cref="addFeatures"/>), the codes of the previous features and the kept joint counts are kept. </summary>
+	/// <param name="threshold">The threshold for discretization.</param>
+	/// <param name="pool">The thread pool used to encode the features.</param>
+	/// <returns> True if success, False if fail (a feature can't be encoded). </returns>
+	bool encodeAppended(const double threshold, CThreadPool& pool);
+
+	/// <summary> Remove the codes and the bit planes (datas are modified or the threshold change). </summary>
+	void invalidateCodes();
+
+	/// <summary> Compute the class state of each sample and the number of samples of each class state. </summary>
+	/// This is done once by <see cref="process"/>, so the mutual infos with the classification target don't convert the classes again.
+	void encodeClasses();
 	
-	/// <summary> Compute the z-score. </summary>
-	/// z-score is compute for each feature separatly.\n
-	/// -# Compute Mean of feature \f$ \mu = \frac{1}{n}\sum_{i=1}^{n}(x_{i}) \f$ \n
-	/// -# Compute The Unbiased estimation of standard deviation \f$ \sigma = \sqrt{\frac{\sum_{i=1}^{n}(x_{i} - \mu)^{2}}{n - 1}} \f$\n
-	/// -# Compute The z-score \f$ z_i = \frac{x_{i} - \mu}{\sigma} \f$
-	void zScore();
-
-	/// <summary> Discretizes the datas with the specified threshold (value became in set  \f$ \{-1,0,1\} \f$). </summary>
+	/// <summary> Statistics of a feature updated value by value (one pass). </summary>
+	/// The mean is the sum divided by the number of values and the variance is computed with the Welford updates (stable without a second pass).
+	struct SFeatureStats
+	{
+		size_t n       = 0;										// Number of values
+		double sum     = 0;										// Sum of the values
+		double running = 0;										// Running mean of the Welford algorithm
+		double m2      = 0;										// Sum of the squared differences to the running mean
+		double min     = std::numeric_limits<double>::infinity();	// Minimum value
+		double max     = -std::numeric_limits<double>::infinity();	// Maximum value
+
+		/// <summary> Add a value. </summary>
+		/// <param name="value">The value.</param>
+		void update(const double value);
+
+		/// <summary> Mean of the feature \f$ \mu = \frac{1}{n}\sum_{i=1}^{n}(x_{i}) \f$. </summary>
+		double mean() const { return sum / double(n); }
+
+		/// <summary> Unbiased estimation of standard deviation \f$ \sigma = \sqrt{\frac{\sum_{i=1}^{n}(x_{i} - \mu)^{2}}{n - 1}} \f$ (0 with only one value). </summary>
+		double std() const { return (n <= 1) ? 0 : std::sqrt(m2 / double(n - 1)); }	//n - 1 is an unbiased version for Gaussian
+	};
+
+	std::vector<SFeatureStats> m_stats;				// Statistics of each feature, computed by the encoding and updated by addSample
+
+	/// <summary> Discretization of the values of a feature, computed once by feature with its statistics. </summary>
+	struct SEncoder
+	{
+		double threshold = 0;					// The threshold for discretization (if infinity, no z-score)
+		EBinning binning = EBinning::Round;		// The binning used with an infinite threshold
+		double mean      = 0;					// The mean of the feature
+		double std       = 1;					// The standard deviation of the feature
+		double min       = 0;					// The minimum value of the feature (EqualWidth binning)
+		double scale     = 0;					// The number of bins divided by the range of the feature (EqualWidth binning, 0 if all values are the same)
+		size_t nBins     = 1;					// The number of bins
+		std::vector<double> edges;				// The upper edges of the first bins (EqualFrequency binning)
+		bool single      = false;				// Too many states : all values in the state 0 (the feature is ignored by the selection)
+
+		/// <summary> Compute the discrete state of a value. </summary>
+		/// -# Compute The z-score \f$ z_i = \frac{x_{i} - \mu}{\sigma} \f$ (see <see cref="SFeatureStats"/>)
+		/// -# Discretizes the z-score with the specified threshold (value became in set \f$ \{-1,0,1\} \f$).
+		/// With an infinite threshold, the value is rounded or binned (see <see cref="EBinning"/>). The state is monotonic with the value.
+		/// <param name="value">The value.</param>
+		/// <returns> The state. </returns>
+		int state(const double value) const;
+	};
+
+	/// <summary> Create the encoder of a feature with its statistics (the edges of EqualFrequency binning are computed by <see cref="encode"/>). </summary>
+	/// <param name="stats">The statistics of the feature.</param>
+	/// <param name="threshold">The threshold for discretization.</param>
+	/// <returns> The encoder. </returns>
+	SEncoder encoder(const SFeatureStats& stats, const double threshold) const;
+
+	/// <summary> Compute the first state and the number of states of a feature with its statistics. </summary>
+	/// <param name="feature">The feature (for the error message).</param>
+	/// <param name="stats">The statistics of the feature.</param>
+	/// <param name="encoder">The encoder of the feature.</param>
+	/// <param name="min">The first state.</param>
+	/// <param name="n">The number of states.</param>
+	/// With too many states to be encoded, all the values are in a single state and the feature is ignored by the selection.
+	static void statesRange(const size_t feature, const SFeatureStats& stats, SEncoder& encoder, int& min, size_t& n);
+
+	/// <summary> Check if the codes are computed with this threshold and the current binning. </summary>
 	/// <param name="threshold">The threshold for discretization.</param>
-	void discretize(const double threshold);
+	/// <returns> True if the codes can be used (even if samples are added after). </returns>
+	bool sameEncoding(const double threshold) const
+	{
+		if (std::isnan(m_codesThreshold) || m_codesThreshold != threshold) { return false; }
+		return !std::isinf(threshold) || (m_codesBinning == m_binning && (m_binning == EBinning::Round || m_codesBins == m_nBins));
+	}
+
+	/// <summary> Encode a feature in the column store (states are shifted in \f$ [0, n[ \f$ with \f$ n \f$ the number of states). </summary>
+	/// This is done once by <see cref="process"/>, so the mutual information works directly on contiguous small states.
+	/// <param name="feature">The feature.</param>
+	/// <param name="threshold">The threshold for discretization (if infinity we only use z-score).</param>
+	/// <returns> True if success, False if fail (too many states to be encoded). </returns>
+	bool encode(const size_t feature, const double threshold);
+
+	/// <summary> Encode the sparse datas (the states of 0 and of the non-zero values whose state is not the state of 0). </summary>
+	/// <param name="threshold">The threshold for discretization (if infinity we only use z-score).</param>
+	/// <param name="pool">The thread pool used to encode the features.</param>
+	/// <returns> True if success, False if fail (too many states or EqualFrequency binning). </returns>
+	bool encodeSparse(const double threshold, CThreadPool& pool);
+
+	/// <summary> Compute the joint counts of two variables with the sparse codes (see <see cref="jointCounts"/>). </summary>
+	/// Only the encoded values are counted, the count of the two zero states is the number of samples minus all other counts.
+	/// <param name="feature1">The feature number 1 (size_t(-1) for the classification target).</param>
+	/// <param name="feature2">The feature number 2 (size_t(-1) for the classification target).</param>
+	/// <param name="counts">The joint counts (n1 x n2).</param>
+	/// <param name="n1">The number of states of the first variable.</param>
+	/// <param name="n2">The number of states of the second variable.</param>
+	void sparseCounts(const size_t feature1, const size_t feature2, std::vector<double>& counts, size_t& n1, size_t& n2) const;
+
+	/// <summary> Build the bit planes of the encoded features and of the classification target with few states. </summary>
+	/// When the two variables of a mutual information have bit planes, the joint counts are popcounts of AND of planes (64 samples by instruction) instead of an increment by sample,
+	/// if the number of popcount passes is below the measured crossover with the generic kernel (see <see cref="MutualInfo::useBitPlanes"/>).
+	/// <param name="pool">The thread pool used to build the features planes.</param>
+	/// <param name="first">The first feature to build (the planes of the previous features and of the classification target are kept if it's not 0).</param>
+	void buildBitPlanes(CThreadPool& pool, const size_t first = 0);
 
 	/// <summary> Mutuals the information. </summary>
 	/// The mutual Information is the a measure of the mutual dependence between the two features.\n
-	/// -# We get the value of the feature (with z-score the value is in set \f$ \{-1,0,1\} \f$ and became in set \f$ \{0,1,2\} \f$ for the next step.\n
-	/// -# We make a matrix with the probability of each value sample by sample.\n
+	/// -# We get the encoded states of the feature (with z-score the value is in set \f$ \{-1,0,1\} \f$ and is encoded in set \f$ \{0,1,2\} \f$).\n
+	/// -# We make a matrix with the probability of each value sample by sample (or with bit planes, see <see cref="buildBitPlanes"/>).\n
 	/// with \f$ s_i \f$ the sample \f$ i \f$, \f$ v^1_i \f$ the value of the first feature for \f$ s_i \f$ and \f$ v^2_i \f$ the value of the second feature for \f$ s_i \f$\n
 	/// \f$ m \f$ is the count of the common values of each sample (\f$\text{count}\left(s_i\left(v^1_i,v^2_i\right)\right)\text{, for each } i \in n\f$ \n
 	/// -# We commpute the mutal information.\n
@@ -111,15 +651,81 @@ private:
 	/// <returns> the mutal information. </returns>
 	double mutualInfo(const size_t feature1 = size_t(-1), const size_t feature2 = size_t(-1)) const;
 
+	/// <summary> Mutual info with the joint counts kept in a table (computed and stored if they are not valid). </summary>
+	/// <param name="variable">The variable of the table (size_t(-1) for the classification target).</param>
+	/// <param name="feature">The feature.</param>
+	/// <param name="table">The table of the variable (nullptr to compute without table). Each thread must use a different feature.</param>
+	/// <returns> the mutal information. </returns>
+	double mutualInfo(const size_t variable, const size_t feature, SCountsTable* table) const;
+
+	/// <summary> Relevance of a block of features, the joint counts with the classification target are filled in one sweep. </summary>
+	/// The features without bit planes are counted by chunks of samples : the class states of a chunk are read once for all the columns of the block,
+	/// and four features are counted together so the increments of a sample are independent. The features with bit planes use the popcount kernel when it's faster.
+	/// <param name="features">The features of the block.</param>
+	/// <param name="n">The number of features.</param>
+	/// <param name="mutualInfos">The relevance of each feature (indexed by feature).</param>
+	/// <param name="table">The table of the classification target (nullptr to compute without table). Each thread must use different features.</param>
+	void relevanceBlock(const size_t* features, const size_t n, double* mutualInfos, SCountsTable* table) const;
+
+	/// <summary> Samples of a selection on a subset (see <see cref="stability"/>). </summary>
+	struct SSubset
+	{
+		const std::vector<size_t>* samples;	// Indexes of the samples
+		const int* classes;					// Class state of each sample of the datas
+		size_t nClass;						// Number of class states
+	};
+
+	/// <summary> Mutual info on a subset of the samples. </summary>
+	/// <param name="variable">The variable (size_t(-1) for the classification target).</param>
+	/// <param name="feature">The feature.</param>
+	/// <param name="subset">The subset.</param>
+	/// <returns> the mutal information. </returns>
+	double mutualInfo(const size_t variable, const size_t feature, const SSubset& subset) const;
+
+	/// <summary> Compute the joint counts of two variables (see <see cref="mutualInfo"/>). </summary>
+	/// <param name="feature1">The feature number 1 (size_t(-1) for the classification target).</param>
+	/// <param name="feature2">The feature number 2 (size_t(-1) for the classification target).</param>
+	/// <param name="counts">The joint counts (n1 x n2).</param>
+	/// <param name="n1">The number of states of the first variable.</param>
+	/// <param name="n2">The number of states of the second variable.</param>
+	void jointCounts(const size_t feature1, const size_t feature2, std::vector<double>& counts, size_t& n1, size_t& n2) const;
+
+	/// <summary> Get the table of the joint counts of a variable, created if needed (nullptr if the incremental mode is disabled). </summary>
+	/// <param name="variable">The variable (size_t(-1) for the classification target).</param>
+	/// <returns> The table. </returns>
+	SCountsTable* countsTable(const size_t variable);
+
+	/// <summary> Add a mutual info to the statistics (before its computation). </summary>
+	/// <param name="variable">The variable (size_t(-1) for the classification target).</param>
+	/// <param name="feature">The feature.</param>
+	/// <param name="table">The table of the variable (nullptr if the incremental mode is disabled).</param>
+	void recordCall(const size_t variable, const size_t feature, const SCountsTable* table) const;
+
+	/// <summary> Update the estimation of the bytes used in the statistics (nothing if disabled). </summary>
+	void updateWorkingSet() const;
+
+	/// <summary> Layout the joint counts of a table with the number of states of the features (the valid joint counts are kept). </summary>
+	/// <param name="variable">The variable of the table (size_t(-1) for the classification target).</param>
+	/// <param name="table">The table.</param>
+	/// <param name="nStates">The number of states of each feature.</param>
+	void layoutTable(const size_t variable, SCountsTable& table, const std::vector<size_t>& nStates) const;
+
 	/// <summary> mRMR (minimum Redundancy Maximum Relevance Feature Selection) algorithm. </summary>
 	/// We use the method describe in the <a href="https://ieeexplore.ieee.org/document/1453511">paper</a>.\n
 	/// -# We Compute the relevance of each feature with the mutal info with the classification target.\n
 	/// -# We sort all in descending value and take the first feature.\n
 	/// -# We loop on all nexted features and compute for each the redundancy of the feature with previous selected features.\n
+	/// The sum of mutual infos with the selected features is kept for each candidate, so each round only adds the mutual info with the last selected feature (or the missing ones with the pruned search, see <see cref="setPruning"/>).\n
 	/// The feature with the best score, the score is compute with two method (<see cref="EMRMRMethod"/>)\n
 	/// \f[ \text{MID} = \text{relevance} - \text{redundancy}\text{, }\quad\text{MIQ} = \frac{\text{relevance}}{\text{redundancy} + 10^{-3}}\f]
-	/// <param name="nFeatures"> The number of features to keep. Default 500 is the original theorical max of the method (not needed but a wink to the origin). </param>
+	/// The relevances and the scores of the candidates are computed in parallel, the best candidate is then searched sequentially in descending relevance order (the result is the same for any number of threads).
+	/// <param name="nFeatures"> The number of features to keep. </param>
 	/// <param name="method"> Method Used for mRMR. </param>
+	/// <param name="pool"> The thread pool used to compute the relevances and the scores. </param>
+	/// <param name="subset"> The subset of the samples (nullptr for all samples). </param>
+	/// <param name="progress"> The control of a progressive selection (nullptr if the selection can't be stopped, see <see cref="processProgressive"/>). </param>
+	/// <param name="start"> The start of the budget of the progressive selection. </param>
 	/// <returns> The selected indexes. </returns>
-	std::vector<size_t> mRMR(const size_t nFeatures = 500, const EMRMRMethod method = EMRMRMethod::MID) const;
+	std::vector<size_t> mRMR(const size_t nFeatures, const EMRMRMethod method, CThreadPool& pool, const SSubset* subset = nullptr, const SProgress* progress = nullptr,
+							 const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::time_point());
 };
@@ -0,0 +1,35 @@
+#include "CMRMRStats.hpp"
+
+#include <sstream>
+#include <iomanip>
+
+using namespace std;
+
+///-------------------------------------------------------------------------------------------------
+string CMRMRStats::toString(const EPhase phase)
+{
+	switch (phase)
+	{
+		case EPhase::Read: return "read";
+		case EPhase::Encode: return "encode";
+		case EPhase::BitPlanes: return "bitPlanes";
+		case EPhase::Relevance: return "relevance";
+		case EPhase::Redundancy: return "redundancy";
+		default: return "unknown";
+	}
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+string CMRMRStats::toJSON() const
+{
+	stringstream ss;
+	ss << setprecision(9) << "{\"times\":{";
+	for (size_t i = 0; i < N_PHASES; ++i) { ss << (i == 0 ? "" : ",") << "\"" << toString(EPhase(i)) << "\":" << m_times[i]; }
+	ss << "},\"mutualInfo\":{\"relevance\":" << m_relevanceCalls << ",\"redundancy\":" << m_redundancyCalls << ",\"cached\":" << m_cachedCalls << "}"
+			<< ",\"histograms\":{\"cells\":" << m_histogramCells << ",\"maxCells\":" << m_maxHistogramCells << "}"
+			<< ",\"workingSet\":{\"last\":" << m_workingSet << ",\"peak\":" << m_peakWorkingSet << "}"
+			<< ",\"pool\":{\"rounds\":" << m_poolRounds << ",\"boundaryRisk\":" << m_boundaryRiskRounds << "}}";
+	return ss.str();
+}
+///-------------------------------------------------------------------------------------------------
@@ -0,0 +1,166 @@
+///-------------------------------------------------------------------------------------------------
+///
+/// \file CMRMRStats.hpp
+/// \brief Timings and counters of the mRMR phases.
+/// \author Thibaut Monseigne (Inria).
+/// \version 1.0.
+/// \date 17/10/2026.
+/// \copyright <a href="https://choosealicense.com/licenses/agpl-3.0/">GNU Affero General Public License v3.0</a>.
+/// \remarks
+/// - The statistics are filled only if an object is given to <see cref="CMRMR::setStats"/>, without object the cost is a null pointer check by phase.
+/// - The values are accumulated until <see cref="CMRMRStats::reset"/>.
+///
+///-------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/// <summary> Phases of the reading and the selection. </summary>
+/// - Read : parse of the CSV file (first pass in streaming mode) or load of the binary file.
+/// - Encode : z-score and discretization of the features (second pass, parse included, in streaming mode).
+/// - BitPlanes : build of the bit planes.
+/// - Relevance : mutual infos of the features with the classification target and sort.
+/// - Redundancy : mutual infos with the selected features and scores of the candidates.
+enum class EPhase { Read, Encode, BitPlanes, Relevance, Redundancy };
+
+class CMRMRStats
+{
+public:
+	static constexpr size_t N_PHASES = 5;	// Number of phases
+
+	/// <summary> Reset all timings and counters. </summary>
+	void reset() { *this = CMRMRStats(); }
+
+	/// <summary> Wall time of a phase. </summary>
+	/// <param name="phase">The phase.</param>
+	/// <returns> The time in seconds. </returns>
+	double time(const EPhase phase) const { return m_times[size_t(phase)]; }
+
+	/// <summary> Number of mutual infos of the features with the classification target. </summary>
+	uint64_t relevanceCalls() const { return m_relevanceCalls; }
+
+	/// <summary> Number of mutual infos between two features. </summary>
+	uint64_t redundancyCalls() const { return m_redundancyCalls; }
+
+	/// <summary> Number of mutual infos with joint counts kept by the incremental mode (no pass on the samples). </summary>
+	uint64_t cachedCalls() const { return m_cachedCalls; }
+
+	/// <summary> Total number of cells of the joint counts (histograms) of all mutual infos. </summary>
+	uint64_t histogramCells() const { return m_histogramCells; }
+
+	/// <summary> Number of cells of the biggest joint counts. </summary>
+	uint64_t maxHistogramCells() const { return m_maxHistogramCells; }
+
+	/// <summary> Estimation of the bytes used by the datas and the buffers (raw datas, codes, bit planes, kept joint counts, selection buffers). </summary>
+	uint64_t workingSet() const { return m_workingSet; }
+
+	/// <summary> Maximum of the estimation of the bytes used (see <see cref="workingSet"/>). </summary>
+	uint64_t peakWorkingSet() const { return m_peakWorkingSet; }
+
+	/// <summary> Number of selection rounds with a candidate pool smaller than the features (see <see cref="CMRMR::setCandidatePool"/>). </summary>
+	uint64_t poolRounds() const { return m_poolRounds; }
+
+	/// <summary> Number of these rounds where a feature out of the pool could beat the selected feature (the bound of its score is greater than the selected score). </summary>
+	/// It's an upper bound of the rounds where the pool boundary changed the selection : the features out of the pool are not scored, only their maximum score is known.
+	/// When it's 0, the selection is the same as without pool. With the prescreen, the bound uses the approximate relevance of the best feature out of the pool,
+	/// so it's not a guarantee anymore. The counter is only meaningful with MID : with MIQ, the redundancy of a feature out of the pool has no lower bound
+	/// (its score is bounded by relevance / 0.0001), so almost every round is counted.
+	uint64_t boundaryRiskRounds() const { return m_boundaryRiskRounds; }
+
+	/// <summary> Add a time to a phase. </summary>
+	/// <param name="phase">The phase.</param>
+	/// <param name="seconds">The time in seconds.</param>
+	void addTime(const EPhase phase, const double seconds) { m_times[size_t(phase)] += seconds; }
+
+	/// <summary> Add mutual infos. </summary>
+	/// <param name="relevance">The number of mutual infos with the classification target.</param>
+	/// <param name="redundancy">The number of mutual infos between two features.</param>
+	/// <param name="cached">The number of these mutual infos computed with kept joint counts.</param>
+	void addCalls(const uint64_t relevance, const uint64_t redundancy, const uint64_t cached)
+	{
+		m_relevanceCalls += relevance;
+		m_redundancyCalls += redundancy;
+		m_cachedCalls += cached;
+	}
+
+	/// <summary> Add the joint counts of a mutual info. </summary>
+	/// <param name="cells">The number of cells of the joint counts.</param>
+	void addHistogram(const uint64_t cells)
+	{
+		m_histogramCells += cells;
+		if (m_maxHistogramCells < cells) { m_maxHistogramCells = cells; }
+	}
+
+	/// <summary> Add a selection round with a candidate pool. </summary>
+	/// <param name="risk">A feature out of the pool could beat the selected feature.</param>
+	void addPoolRound(const bool risk)
+	{
+		m_poolRounds++;
+		if (risk) { m_boundaryRiskRounds++; }
+	}
+
+	/// <summary> Set the current estimation of the bytes used (the peak is updated). </summary>
+	/// <param name="bytes">The bytes.</param>
+	void setWorkingSet(const uint64_t bytes)
+	{
+		m_workingSet = bytes;
+		if (m_peakWorkingSet < bytes) { m_peakWorkingSet = bytes; }
+	}
+
+	/// <summary> Name of a phase. </summary>
+	/// <param name="phase">The phase.</param>
+	/// <returns> The name. </returns>
+	static std::string toString(const EPhase phase);
+
+	/// <summary> Dump the statistics in JSON. </summary>
+	/// <returns> The JSON object. </returns>
+	std::string toJSON() const;
+
+private:
+	std::array<double, N_PHASES> m_times {};	// Wall time of each phase (seconds)
+	uint64_t m_relevanceCalls    = 0;			// Number of mutual infos with the classification target
+	uint64_t m_redundancyCalls   = 0;			// Number of mutual infos between two features
+	uint64_t m_cachedCalls       = 0;			// Number of mutual infos with kept joint counts
+	uint64_t m_histogramCells    = 0;			// Total cells of the joint counts
+	uint64_t m_maxHistogramCells = 0;			// Cells of the biggest joint counts
+	uint64_t m_workingSet        = 0;			// Last estimation of the bytes used
+	uint64_t m_peakWorkingSet    = 0;			// Maximum estimation of the bytes used
+	uint64_t m_poolRounds        = 0;			// Number of rounds with a candidate pool
+	uint64_t m_boundaryRiskRounds = 0;			// Number of rounds where the pool boundary could change the selection (upper bound)
+};
+
+/// <summary> Measure the wall time of a scope and add it to a phase (nothing if the statistics are disabled). </summary>
+class CPhaseTimer
+{
+public:
+	/// <summary> Initializes a new instance of the <see cref="CPhaseTimer"/> class (start the timer). </summary>
+	/// <param name="stats">The statistics (nullptr if disabled).</param>
+	/// <param name="phase">The phase.</param>
+	CPhaseTimer(CMRMRStats* stats, const EPhase phase) : m_stats(stats), m_phase(phase)
+	{
+		if (m_stats != nullptr) { m_start = std::chrono::steady_clock::now(); }
+	}
+
+	/// <summary> Finalizes an instance of the <see cref="CPhaseTimer"/> class (add the time to the phase). </summary>
+	~CPhaseTimer() { stop(); }
+
+	CPhaseTimer(const CPhaseTimer&)            = delete;
+	CPhaseTimer& operator=(const CPhaseTimer&) = delete;
+
+	/// <summary> Stop the timer before the end of the scope. </summary>
+	void stop()
+	{
+		if (m_stats == nullptr) { return; }
+		m_stats->addTime(m_phase, std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count());
+		m_stats = nullptr;
+	}
+
+private:
+	CMRMRStats* m_stats;
+	EPhase m_phase;
+	std::chrono::steady_clock::time_point m_start;
+};
@@ -0,0 +1,143 @@
+#include "CMappedFile.hpp"
+
+#include <cstdio>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+///-------------------------------------------------------------------------------------------------
+bool CMappedFile::open(const string& filename)
+{
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) { return false; }
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	m_file   = file;
+	m_size   = size_t(size.QuadPart);
+	m_opened = true;
+	if (m_size == 0) { return true; }	// Empty file can't be mapped
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping != nullptr) { m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)); }
+#else
+	const int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) { return false; }
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+	m_size   = size_t(st.st_size);
+	m_opened = true;
+	if (m_size != 0)	// Empty file can't be mapped
+	{
+		void* map = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (map != MAP_FAILED) { m_data = static_cast<const char*>(map); }
+	}
+	::close(fd);	// The mapping keeps a reference on the file
+	if (m_size == 0) { return true; }
+#endif
+	if (m_data == nullptr)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMappedFile::create(const string& filename, const size_t size, const bool temporary)
+{
+	close();
+	if (size == 0) { return false; }	// Empty file can't be mapped
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) { return false; }
+	m_file = file;
+	LARGE_INTEGER end;
+	end.QuadPart = LONGLONG(size);
+	if (SetFilePointerEx(file, end, nullptr, FILE_BEGIN) && SetEndOfFile(file))	// The space is allocated (the write of a page can't fail later for a full disk)
+	{
+		m_mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, DWORD(uint64_t(size) >> 32), DWORD(uint64_t(size) & 0xFFFFFFFF), nullptr);
+		if (m_mapping != nullptr) { m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0)); }
+	}
+#else
+	const int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) { return false; }
+#ifdef __APPLE__
+	const bool reserved = ftruncate(fd, off_t(size)) == 0;
+#else
+	const bool reserved = posix_fallocate(fd, 0, off_t(size)) == 0;	// Not a sparse file, the write of a page can't fail later (SIGBUS) for a full disk
+#endif
+	if (reserved)
+	{
+		void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map != MAP_FAILED) { m_data = static_cast<const char*>(map); }
+	}
+	::close(fd);	// The mapping keeps a reference on the file
+#endif
+	m_size      = size;
+	m_opened    = true;
+	m_writable  = true;
+	m_temporary = temporary ? filename : "";
+	if (m_data == nullptr)
+	{
+		m_temporary = filename;	// Remove the incomplete file
+		close();
+		return false;
+	}
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CMappedFile::flush() const
+{
+	if (!m_writable || m_data == nullptr) { return false; }
+#ifdef _WIN32
+	return FlushViewOfFile(m_data, 0) && FlushFileBuffers(m_file);
+#else
+	return msync(const_cast<char*>(m_data), m_size, MS_SYNC) == 0;
+#endif
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CMappedFile::close()
+{
+#ifdef _WIN32
+	if (m_data != nullptr) { UnmapViewOfFile(m_data); }
+	if (m_mapping != nullptr) { CloseHandle(m_mapping); }
+	if (m_file != nullptr) { CloseHandle(m_file); }
+	m_mapping = nullptr;
+	m_file    = nullptr;
+#else
+	if (m_data != nullptr) { munmap(const_cast<char*>(m_data), m_size); }
+#endif
+	if (!m_temporary.empty()) { remove(m_temporary.c_str()); }
+	m_data     = nullptr;
+	m_size     = 0;
+	m_opened   = false;
+	m_writable = false;
+	m_temporary.clear();
+}
+///-------------------------------------------------------------------------------------------------
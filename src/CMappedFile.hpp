@@ -0,0 +1,76 @@
+///-------------------------------------------------------------------------------------------------
+/// 
+/// \file CMappedFile.hpp
+/// \brief Memory mapped file (an existing file in read only memory, or a created or temporary file in read write memory).
+/// \author Thibaut Monseigne (Inria).
+/// \version 1.0.
+/// \date 17/10/2026.
+/// \copyright <a href="https://choosealicense.com/licenses/agpl-3.0/">GNU Affero General Public License v3.0</a>.
+/// 
+///-------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <string>
+
+class CMappedFile
+{
+public:
+	/// <summary> Initializes a new instance of the <see cref="CMappedFile"/> class. </summary>
+	CMappedFile() = default;
+
+	/// <summary> Finalizes an instance of the <see cref="CMappedFile"/> class (unmap the file). </summary>
+	~CMappedFile() { close(); }
+
+	CMappedFile(const CMappedFile&)            = delete;
+	CMappedFile& operator=(const CMappedFile&) = delete;
+
+	/// <summary> Map all the file in read only memory. </summary>
+	/// The pages are shared with the system cache, so other processes mapping the same file use the same physical memory.
+	/// <param name="filename">The filename.</param>
+	/// <returns> True if Succes, False if Fail. </returns>
+	bool open(const std::string& filename);
+
+	/// <summary> Create a file of this size and map it in read write memory. </summary>
+	/// The file content is written back by the system when the pages are no longer used, so the file can be bigger than the memory.
+	/// The space of the file is allocated, so the creation fails if the disk is full instead of the write of a page.
+	/// <param name="filename">The filename.</param>
+	/// <param name="size">The size of the file.</param>
+	/// <param name="temporary">If true, the file is removed when it is unmapped.</param>
+	/// <returns> True if Succes, False if Fail. </returns>
+	bool create(const std::string& filename, const size_t size, const bool temporary = true);
+
+	/// <summary> Write the modified pages of a created file to the disk and wait for the end of the write. </summary>
+	/// <returns> True if Succes, False if Fail (the file is not created by <see cref="create"/> or the write fails). </returns>
+	bool flush() const;
+
+	/// <summary> Unmap the file. </summary>
+	void close();
+
+	/// <summary> Check if a file is mapped. </summary>
+	/// <returns> True if a file is mapped. </returns>
+	bool isOpen() const { return m_opened; }
+
+	/// <summary> Get the begin of the file. </summary>
+	/// <returns> The pointer on the first byte (nullptr for an empty file). </returns>
+	const char* data() const { return m_data; }
+
+	/// <summary> Get the begin of the file to write. </summary>
+	/// <returns> The pointer on the first byte (nullptr if the file is not created by <see cref="create"/>). </returns>
+	char* writableData() const { return m_writable ? const_cast<char*>(m_data) : nullptr; }
+
+	/// <summary> Get the size of the file. </summary>
+	/// <returns> The number of bytes. </returns>
+	size_t size() const { return m_size; }
+
+private:
+	const char* m_data = nullptr;	// Mapped memory
+	size_t m_size      = 0;			// Size of the file
+	bool m_opened      = false;		// A file is mapped
+	bool m_writable    = false;		// The file is mapped in read write memory
+	std::string m_temporary;		// Filename to remove when the file is unmapped
+#ifdef _WIN32
+	void* m_file    = nullptr;		// File handle
+	void* m_mapping = nullptr;		// File mapping handle
+#endif
+};
@@ -0,0 +1,176 @@
+#include "CSocket.hpp"
+
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+#ifdef _WIN32
+/// <summary> Initialize Winsock once. </summary>
+bool startup()
+{
+	static const bool started = []
+	{
+		WSADATA data;
+		return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}();
+	return started;
+}
+#else
+bool startup() { return true; }
+#endif
+
+/// <summary> Disable the Nagle algorithm (the messages are small and each one waits for an answer). </summary>
+void noDelay(const intptr_t socket)
+{
+	int flag = 1;
+	setsockopt(decltype(::socket(0, 0, 0))(socket), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&flag), sizeof(flag));
+}
+}	// namespace
+
+///-------------------------------------------------------------------------------------------------
+bool CSocket::listen(const uint16_t port)
+{
+	close();
+	if (!startup()) { return false; }
+	const auto s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	m_socket     = intptr_t(s);
+	if (!isOpen()) { return false; }
+	int reuse = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family      = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port        = htons(port);
+	if (::bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(s, 16) != 0)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CSocket::accept(CSocket& client) const
+{
+	client.close();
+	if (!isOpen()) { return false; }
+	client.m_socket = intptr_t(::accept(decltype(::socket(0, 0, 0))(m_socket), nullptr, nullptr));
+	if (!client.isOpen()) { return false; }
+	noDelay(client.m_socket);
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CSocket::connect(const string& host, const uint16_t port)
+{
+	close();
+	if (!startup()) { return false; }
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* result  = nullptr;
+	if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &result) != 0) { return false; }
+	for (const addrinfo* it = result; it != nullptr; it = it->ai_next)
+	{
+		const auto s = ::socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+		m_socket     = intptr_t(s);
+		if (!isOpen()) { continue; }
+		if (::connect(s, it->ai_addr, socklen_t(it->ai_addrlen)) == 0) { break; }
+		close();
+	}
+	freeaddrinfo(result);
+	if (!isOpen()) { return false; }
+	noDelay(m_socket);
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CSocket::send(const void* data, const size_t size) const
+{
+	const char* bytes = static_cast<const char*>(data);
+	size_t done       = 0;
+	while (done < size)
+	{
+		const int chunk = int(min(size - done, size_t(1) << 30));
+#ifdef _WIN32
+		const int sent = ::send(SOCKET(m_socket), bytes + done, chunk, 0);
+#else
+		const ssize_t sent = ::send(int(m_socket), bytes + done, size_t(chunk), MSG_NOSIGNAL);
+#endif
+		if (sent <= 0) { return false; }
+		done += size_t(sent);
+	}
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+bool CSocket::receive(void* data, const size_t size) const
+{
+	char* bytes = static_cast<char*>(data);
+	size_t done = 0;
+	while (done < size)
+	{
+		const int chunk = int(min(size - done, size_t(1) << 30));
+#ifdef _WIN32
+		const int received = ::recv(SOCKET(m_socket), bytes + done, chunk, 0);
+#else
+		const ssize_t received = ::recv(int(m_socket), bytes + done, size_t(chunk), 0);
+#endif
+		if (received <= 0) { return false; }
+		done += size_t(received);
+	}
+	return true;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CSocket::close()
+{
+	if (!isOpen()) { return; }
+#ifdef _WIN32
+	closesocket(SOCKET(m_socket));
+#else
+	::close(int(m_socket));
+#endif
+	m_socket = INVALID;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+uint16_t CSocket::port() const
+{
+	if (!isOpen()) { return 0; }
+	sockaddr_in address;
+	socklen_t size = sizeof(address);
+	if (getsockname(decltype(::socket(0, 0, 0))(m_socket), reinterpret_cast<sockaddr*>(&address), &size) != 0) { return 0; }
+	return ntohs(address.sin_port);
+}
+///-------------------------------------------------------------------------------------------------
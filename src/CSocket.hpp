@@ -0,0 +1,71 @@
+///-------------------------------------------------------------------------------------------------
+///
+/// \file CSocket.hpp
+/// \brief Blocking TCP socket (used by the sharded selection).
+/// \author Thibaut Monseigne (Inria).
+/// \version 1.0.
+/// \date 17/10/2026.
+/// \copyright <a href="https://choosealicense.com/licenses/agpl-3.0/">GNU Affero General Public License v3.0</a>.
+///
+///-------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class CSocket
+{
+public:
+	/// <summary> Initializes a new instance of the <see cref="CSocket"/> class. </summary>
+	CSocket() = default;
+
+	/// <summary> Finalizes an instance of the <see cref="CSocket"/> class (close the socket). </summary>
+	~CSocket() { close(); }
+
+	CSocket(const CSocket&)            = delete;
+	CSocket& operator=(const CSocket&) = delete;
+
+	/// <summary> Listen for connections on all interfaces. </summary>
+	/// <param name="port">The port (0 to use a free port, see <see cref="port"/>).</param>
+	/// <returns> True if Succes, False if Fail. </returns>
+	bool listen(const uint16_t port);
+
+	/// <summary> Wait for a connection on a listening socket. </summary>
+	/// <param name="client">The socket of the connection.</param>
+	/// <returns> True if Succes, False if Fail. </returns>
+	bool accept(CSocket& client) const;
+
+	/// <summary> Connect to a listening socket. </summary>
+	/// <param name="host">The host name or address.</param>
+	/// <param name="port">The port.</param>
+	/// <returns> True if Succes, False if Fail. </returns>
+	bool connect(const std::string& host, const uint16_t port);
+
+	/// <summary> Send all the bytes. </summary>
+	/// <param name="data">The bytes.</param>
+	/// <param name="size">The number of bytes.</param>
+	/// <returns> True if Succes, False if Fail (connection closed). </returns>
+	bool send(const void* data, const size_t size) const;
+
+	/// <summary> Receive exactly this number of bytes. </summary>
+	/// <param name="data">The bytes.</param>
+	/// <param name="size">The number of bytes.</param>
+	/// <returns> True if Succes, False if Fail (connection closed). </returns>
+	bool receive(void* data, const size_t size) const;
+
+	/// <summary> Close the socket. </summary>
+	void close();
+
+	/// <summary> Check if the socket is open. </summary>
+	/// <returns> True if the socket is open. </returns>
+	bool isOpen() const { return m_socket != INVALID; }
+
+	/// <summary> Get the local port of the socket. </summary>
+	/// <returns> The port (0 if the socket is not open). </returns>
+	uint16_t port() const;
+
+private:
+	static constexpr intptr_t INVALID = -1;	// Not opened socket
+	intptr_t m_socket = INVALID;			// Socket descriptor (SOCKET on Windows)
+};
@@ -0,0 +1,91 @@
+#include "CThreadPool.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+///-------------------------------------------------------------------------------------------------
+CThreadPool::CThreadPool(const size_t nThreads)
+{
+	size_t n = (nThreads == 0) ? size_t(thread::hardware_concurrency()) : nThreads;
+	if (n == 0) { n = 1; }
+	m_workers.reserve(n - 1);
+	for (size_t i = 1; i < n; ++i) { m_workers.emplace_back(&CThreadPool::workerLoop, this); }
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+CThreadPool::~CThreadPool()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wakeUp.notify_all();
+	for (auto& w : m_workers) { w.join(); }
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CThreadPool::parallelFor(const size_t n, const function<void(size_t, size_t)>& func, size_t chunk)
+{
+	if (n == 0) { return; }
+	if (m_workers.empty() || n == 1)	// Nothing to share
+	{
+		func(0, n);
+		return;
+	}
+	if (chunk == 0) { chunk = max(size_t(1), n / (8 * size())); }	// Some chunks by threads to balance the load
+
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_job     = &func;
+		m_size    = n;
+		m_chunk   = chunk;
+		m_next    = 0;
+		m_running = m_workers.size();
+		++m_generation;
+	}
+	m_wakeUp.notify_all();
+
+	runChunks();
+
+	unique_lock<mutex> lock(m_mutex);
+	m_done.wait(lock, [this] { return m_running == 0; });
+	m_job = nullptr;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CThreadPool::workerLoop()
+{
+	size_t generation = 0;
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_wakeUp.wait(lock, [&] { return m_stop || m_generation != generation; });
+			if (m_stop) { return; }
+			generation = m_generation;
+		}
+		runChunks();
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (--m_running == 0) { m_done.notify_one(); }
+		}
+	}
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void CThreadPool::runChunks()
+{
+	const auto& func = *m_job;
+	while (true)
+	{
+		const size_t begin = m_next.fetch_add(m_chunk);
+		if (begin >= m_size) { return; }
+		func(begin, min(begin + m_chunk, m_size));
+	}
+}
+///-------------------------------------------------------------------------------------------------
@@ -0,0 +1,62 @@
+///-------------------------------------------------------------------------------------------------
+/// 
+/// \file CThreadPool.hpp
+/// \brief Thread Pool used to split loops on all cores.
+/// \author Thibaut Monseigne (Inria).
+/// \version 1.0.
+/// \date 17/10/2026.
+/// \copyright <a href="https://choosealicense.com/licenses/agpl-3.0/">GNU Affero General Public License v3.0</a>.
+/// 
+///-------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CThreadPool
+{
+public:
+	/// <summary> Initializes a new instance of the <see cref="CThreadPool"/> class. </summary>
+	/// <param name="nThreads">The number of threads (the calling thread included). 0 to use all hardware threads.</param>
+	explicit CThreadPool(const size_t nThreads = 1);
+
+	/// <summary> Finalizes an instance of the <see cref="CThreadPool"/> class (wait and join all workers). </summary>
+	~CThreadPool();
+
+	CThreadPool(const CThreadPool&)            = delete;
+	CThreadPool& operator=(const CThreadPool&) = delete;
+
+	/// <summary> Number of threads used by <see cref="parallelFor"/> (the calling thread included). </summary>
+	/// <returns> the number of threads. </returns>
+	size_t size() const { return m_workers.size() + 1; }
+
+	/// <summary> Run the function on all the range \f$ [0, n[ \f$ split in chunks. </summary>
+	/// The chunks are dynamically taken by the threads when they are free, the calling thread works too and the function returns when all chunks are done.\n
+	/// The order of the chunks is not deterministic, the function must only write in the chunk indexes.
+	/// <param name="n">The size of the range.</param>
+	/// <param name="func">The function called with the range \f$ [begin, end[ \f$ of a chunk.</param>
+	/// <param name="chunk">The size of a chunk (0 to choose a size which give several chunks by threads).</param>
+	void parallelFor(const size_t n, const std::function<void(size_t, size_t)>& func, size_t chunk = 0);
+
+private:
+	/// <summary> Loop of a worker : wait a job, work and signal the end. </summary>
+	void workerLoop();
+
+	/// <summary> Take and run the chunks of the current job until there is no more. </summary>
+	void runChunks();
+
+	std::vector<std::thread> m_workers;					// Workers (the calling thread is not included)
+	std::mutex m_mutex;									// Mutex for the job and the state
+	std::condition_variable m_wakeUp, m_done;			// Signals to the workers and to the calling thread
+	const std::function<void(size_t, size_t)>* m_job = nullptr;	// Current job
+	size_t m_size = 0, m_chunk = 1;						// Size of the current job and size of a chunk
+	std::atomic<size_t> m_next{ 0 };					// Next index to take in the current job
+	size_t m_generation = 0;							// Job counter (a worker works once by job)
+	size_t m_running    = 0;							// Number of workers on the current job
+	bool m_stop         = false;						// Stop the workers
+};
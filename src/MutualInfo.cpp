@@ -0,0 +1,193 @@
+#include "MutualInfo.hpp"
+
+#include <cmath>
+#include <type_traits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace MutualInfo
+{
+namespace
+{
+///-------------------------------------------------------------------------------------------------
+/// <summary> Number of bits set in a word (popcnt instruction if the build targets it, bit operations otherwise). </summary>
+inline size_t popcount(const uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return size_t(__popcnt64(x));
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__POPCNT__) || !(defined(__x86_64__) || defined(__i386__)))
+	return size_t(__builtin_popcountll(x));
+#else
+	uint64_t v = x - ((x >> 1) & 0x5555555555555555ULL);
+	v          = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+	v          = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return size_t((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Number of bits set in the AND of two planes. </summary>
+size_t andCount(const uint64_t* a, const uint64_t* b, const size_t words)
+{
+	size_t count = 0;
+	for (size_t w = 0; w < words; ++w) { count += popcount(a[w] & b[w]); }
+	return count;
+}
+///-------------------------------------------------------------------------------------------------
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && !defined(__POPCNT__)
+#define MUTUALINFO_POPCNT_DISPATCH
+///-------------------------------------------------------------------------------------------------
+/// <summary> Number of bits set in the AND of two planes compiled with the popcnt instruction (used only if the processor has it). </summary>
+__attribute__((target("popcnt"))) size_t andCountPopcnt(const uint64_t* a, const uint64_t* b, const size_t words)
+{
+	size_t count = 0;
+	for (size_t w = 0; w < words; ++w) { count += size_t(__builtin_popcountll(a[w] & b[w])); }
+	return count;
+}
+///-------------------------------------------------------------------------------------------------
+#endif
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Check if the number of bits set is computed by the popcnt instruction. </summary>
+bool hasPopcnt()
+{
+#if defined(MUTUALINFO_POPCNT_DISPATCH)
+	static const bool has = __builtin_cpu_supports("popcnt");
+	return has;
+#elif defined(__POPCNT__) || defined(__aarch64__) || (defined(_MSC_VER) && defined(_M_X64))
+	return true;
+#else
+	return false;
+#endif
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Kernel for the number of bits set in the AND of two planes (chosen once from the processor at runtime). </summary>
+using AndCount = size_t (*)(const uint64_t*, const uint64_t*, const size_t);
+AndCount andCountKernel()
+{
+#ifdef MUTUALINFO_POPCNT_DISPATCH
+	if (hasPopcnt()) { return andCountPopcnt; }
+#endif
+	return andCount;
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Mutual information from joint counts (the numbers of states are size_t or std::integral_constant to unroll the loops). </summary>
+template <typename N1, typename N2>
+double probabilities(double* counts, const N1 n1, const N2 n2, const size_t n, double* proba1, double* proba2)
+{
+	// Joint Probabilities
+	for (size_t k = 0; k < size_t(n1) * size_t(n2); ++k) { counts[k] /= n; }
+
+	// Mutual Information
+	for (size_t i = 0; i < size_t(n1); ++i) { proba1[i] = 0.0; }
+	for (size_t j = 0; j < size_t(n2); ++j) { proba2[j] = 0.0; }
+	for (size_t i = 0; i < size_t(n1); ++i)
+	{
+		for (size_t j = 0; j < size_t(n2); ++j)
+		{
+			proba1[i] += counts[i * n2 + j];
+			proba2[j] += counts[i * n2 + j];
+		}
+	}
+
+	double res = 0.0;
+	for (size_t i = 0; i < size_t(n1); ++i)
+	{
+		for (size_t j = 0; j < size_t(n2); ++j)
+		{
+			const double p = counts[i * n2 + j];
+			if (p != 0 && proba1[i] != 0 && proba2[j] != 0) { res += p * log(p / proba1[i] / proba2[j]); }
+		}
+	}
+	res /= log(2);
+	return (res > 0.0) ? res : 0.0;	// The rounding can give a tiny negative value for independent variables
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Mutual information of a 3 states variable and a N states variable (marginals on the stack). </summary>
+template <size_t N>
+double withThree(double* counts, const bool threeFirst, const size_t n)
+{
+	double proba[3 + N];
+	if (threeFirst) { return probabilities(counts, integral_constant<size_t, 3>(), integral_constant<size_t, N>(), n, proba, proba + 3); }
+	return probabilities(counts, integral_constant<size_t, N>(), integral_constant<size_t, 3>(), n, proba, proba + N);
+}
+///-------------------------------------------------------------------------------------------------
+}	// namespace
+
+///-------------------------------------------------------------------------------------------------
+size_t maxBitPasses() { return hasPopcnt() ? 64 : 24; }
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+double fromCounts(double* counts, const size_t n1, const size_t n2, const size_t n, double* marginals)
+{
+	// Specializations for 3 states and a variable with few states
+	const size_t other = (n1 == 3) ? n2 : (n2 == 3) ? n1 : 0;
+	switch (other)
+	{
+		case 2: return withThree<2>(counts, n1 == 3, n);
+		case 3: return withThree<3>(counts, n1 == 3, n);
+		case 4: return withThree<4>(counts, n1 == 3, n);
+		case 5: return withThree<5>(counts, n1 == 3, n);
+		case 6: return withThree<6>(counts, n1 == 3, n);
+		case 7: return withThree<7>(counts, n1 == 3, n);
+		case 8: return withThree<8>(counts, n1 == 3, n);
+		default: return probabilities(counts, n1, n2, n, marginals, marginals + n1);
+	}
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+void bitPlanesCounts(const uint64_t* p1, const size_t* c1, const size_t n1, const uint64_t* p2, const size_t* c2, const size_t n2, const size_t n, vector<double>& counts)
+{
+	const size_t words      = nWords(n);
+	const AndCount kernel   = andCountKernel();
+	size_t joint[MAX_BIT_STATES][MAX_BIT_STATES] = {};
+
+	// Popcount of the AND for all states except the last of each variable
+	for (size_t i = 0; i + 1 < n1; ++i)
+	{
+		const uint64_t* a = p1 + i * words;
+		for (size_t j = 0; j + 1 < n2; ++j) { joint[i][j] = kernel(a, p2 + j * words, words); }
+	}
+
+	// Last column and last row are deduced from the counts of each state
+	for (size_t i = 0; i + 1 < n1; ++i)
+	{
+		size_t sum = 0;
+		for (size_t j = 0; j + 1 < n2; ++j) { sum += joint[i][j]; }
+		joint[i][n2 - 1] = c1[i] - sum;
+	}
+	for (size_t j = 0; j < n2; ++j)
+	{
+		size_t sum = 0;
+		for (size_t i = 0; i + 1 < n1; ++i) { sum += joint[i][j]; }
+		joint[n1 - 1][j] = c2[j] - sum;
+	}
+
+	counts.resize(n1 * n2);
+	for (size_t i = 0; i < n1; ++i) { for (size_t j = 0; j < n2; ++j) { counts[i * n2 + j] = double(joint[i][j]); } }
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+double bitPlanes(const uint64_t* p1, const size_t* c1, const size_t n1, const uint64_t* p2, const size_t* c2, const size_t n2, const size_t n)
+{
+	vector<double> counts;
+	bitPlanesCounts(p1, c1, n1, p2, c2, n2, n, counts);
+	return fromCounts(counts, n1, n2, n);
+}
+///-------------------------------------------------------------------------------------------------
+}	// namespace MutualInfo
@@ -0,0 +1,171 @@
+///-------------------------------------------------------------------------------------------------
+/// 
+/// \file MutualInfo.hpp
+/// \brief Mutual Information kernels on encoded states.
+/// \author Thibaut Monseigne (Inria).
+/// \version 1.0.
+/// \date 17/10/2026.
+/// \copyright <a href="https://choosealicense.com/licenses/agpl-3.0/">GNU Affero General Public License v3.0</a>.
+/// \remarks 
+/// - All kernels give exactly the same value for the same joint counts (the final computation is shared by <see cref="MutualInfo::fromCounts"/>).
+/// 
+///-------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MutualInfo
+{
+/// <summary> Maximum number of states to encode a variable with bit planes. </summary>
+constexpr size_t MAX_BIT_STATES = 8;
+
+/// <summary> Maximum number of popcount passes over the planes for which the bit planes kernel is faster than the generic kernel. </summary>
+/// A joint counts table of \f$ n_1 \times n_2 \f$ states needs \f$ (n_1 - 1) \times (n_2 - 1) \f$ passes of \f$ n / 64 \f$ words, the generic kernel one increment by sample.
+/// With 100000 samples (BM_mutualInfoGeneric and BM_mutualInfoBitPlanes), a pass takes about 1.2 µs with the popcnt instruction and 3 µs without, the generic kernel 100 to 150 µs.
+/// <returns> the number of passes (64 with the popcnt instruction, 24 without). </returns>
+size_t maxBitPasses();
+
+/// <summary> Check if the bit planes kernel is faster than the generic kernel for two variables (both must have at most <see cref="MAX_BIT_STATES"/> states). </summary>
+/// <param name="n1">The number of states of the first variable.</param>
+/// <param name="n2">The number of states of the second variable.</param>
+/// <returns> True if the bit planes kernel must be used. </returns>
+inline bool useBitPlanes(const size_t n1, const size_t n2) { return n1 <= MAX_BIT_STATES && n2 <= MAX_BIT_STATES && (n1 - 1) * (n2 - 1) <= maxBitPasses(); }
+
+/// <summary> Number of 64 bits words of a bit plane. </summary>
+/// <param name="n">The number of samples.</param>
+/// <returns> the number of words. </returns>
+inline size_t nWords(const size_t n) { return (n + 63) / 64; }
+
+/// <summary> Buffers of the mutual informations kept by the caller (one by thread), the heap is used only when a buffer grows. </summary>
+struct SWorkspace
+{
+	std::vector<double> counts;		// Joint counts (row major n1 x n2)
+	std::vector<double> marginals;	// Marginal probabilities of the two variables (n1 + n2)
+};
+
+/// <summary> Compute the mutual information from a joint counts table. </summary>
+/// With \f$ n_1 \f$ the number of state for variable 1, \f$ n_2 \f$ the number of state for variable 2. \f$ p \f$ the probability.\n
+/// \f[ mi = \sum_{i\in n_1, j \in n_2}{p_{i,j} * \log\left(\frac{p_{i,j}}{p_{i} \times p_{j}}\right)} \f]
+/// The tables with 3 states (discretization with a threshold) and at most <see cref="MAX_BIT_STATES"/> states for the other variable (classification target) use a specialization
+/// with the numbers of states known at compile time and the marginals on the stack. The operations are done in the same order, so the value is the same.
+/// The value is clamped at 0 : the rounding can give a tiny negative value and the bounds of the scores rely on a redundancy never negative.
+/// <param name="counts">The joint counts (row major \f$ n_1 \times n_2 \f$), it's modified to contain the joint probabilities.</param>
+/// <param name="n1">The number of states of the first variable.</param>
+/// <param name="n2">The number of states of the second variable.</param>
+/// <param name="n">The number of samples.</param>
+/// <param name="marginals">The buffer of the marginal probabilities (\f$ n_1 + n_2 \f$ values).</param>
+/// <returns> the mutal information. </returns>
+double fromCounts(double* counts, const size_t n1, const size_t n2, const size_t n, double* marginals);
+
+/// <summary> Compute the mutual information from the joint counts of a workspace (see <see cref="fromCounts(double*, const size_t, const size_t, const size_t, double*)"/>). </summary>
+/// <param name="workspace">The workspace with the joint counts (modified to contain the joint probabilities).</param>
+/// <param name="n1">The number of states of the first variable.</param>
+/// <param name="n2">The number of states of the second variable.</param>
+/// <param name="n">The number of samples.</param>
+/// <returns> the mutal information. </returns>
+inline double fromCounts(SWorkspace& workspace, const size_t n1, const size_t n2, const size_t n)
+{
+	workspace.marginals.resize(n1 + n2);
+	return fromCounts(workspace.counts.data(), n1, n2, n, workspace.marginals.data());
+}
+
+/// <summary> Compute the mutual information from a joint counts table (the marginals are allocated). </summary>
+/// <param name="counts">The joint counts (row major \f$ n_1 \times n_2 \f$), it's modified to contain the joint probabilities.</param>
+/// <param name="n1">The number of states of the first variable.</param>
+/// <param name="n2">The number of states of the second variable.</param>
+/// <param name="n">The number of samples.</param>
+/// <returns> the mutal information. </returns>
+inline double fromCounts(std::vector<double>& counts, const size_t n1, const size_t n2, const size_t n)
+{
+	std::vector<double> marginals(n1 + n2);
+	return fromCounts(counts.data(), n1, n2, n, marginals.data());
+}
+
+/// <summary> Joint counts of two vectors of states (one increment by sample). </summary>
+/// <param name="v1">The states of the first variable (in \f$ [0, n_1[ \f$).</param>
+/// <param name="n1">The number of states of the first variable.</param>
+/// <param name="v2">The states of the second variable (in \f$ [0, n_2[ \f$).</param>
+/// <param name="n2">The number of states of the second variable.</param>
+/// <param name="n">The number of samples.</param>
+/// <param name="counts">The joint counts (row major \f$ n_1 \times n_2 \f$).</param>
+template <typename T1, typename T2>
+void genericCounts(const T1* v1, const size_t n1, const T2* v2, const size_t n2, const size_t n, std::vector<double>& counts)
+{
+	counts.assign(n1 * n2, 0.0);
+	for (size_t i = 0; i < n; ++i) { counts[size_t(v1[i]) * n2 + size_t(v2[i])]++; }
+}
+
+/// <summary> Joint counts of two vectors of states on a subset of the samples. </summary>
+/// <param name="v1">The states of the first variable (in \f$ [0, n_1[ \f$).</param>
+/// <param name="n1">The number of states of the first variable.</param>
+/// <param name="v2">The states of the second variable (in \f$ [0, n_2[ \f$).</param>
+/// <param name="n2">The number of states of the second variable.</param>
+/// <param name="samples">The indexes of the samples (an index can be repeated).</param>
+/// <param name="n">The number of indexes.</param>
+/// <param name="counts">The joint counts (row major \f$ n_1 \times n_2 \f$).</param>
+template <typename T1, typename T2>
+void indexedCounts(const T1* v1, const size_t n1, const T2* v2, const size_t n2, const size_t* samples, const size_t n, std::vector<double>& counts)
+{
+	counts.assign(n1 * n2, 0.0);
+	for (size_t i = 0; i < n; ++i) { counts[size_t(v1[samples[i]]) * n2 + size_t(v2[samples[i]])]++; }
+}
+
+/// <summary> Mutual information between two vectors of states (one increment by sample). </summary>
+/// <param name="v1">The states of the first variable (in \f$ [0, n_1[ \f$).</param>
+/// <param name="n1">The number of states of the first variable.</param>
+/// <param name="v2">The states of the second variable (in \f$ [0, n_2[ \f$).</param>
+/// <param name="n2">The number of states of the second variable.</param>
+/// <param name="n">The number of samples.</param>
+/// <returns> the mutal information. </returns>
+template <typename T1, typename T2>
+double generic(const T1* v1, const size_t n1, const T2* v2, const size_t n2, const size_t n)
+{
+	std::vector<double> counts;
+	genericCounts(v1, n1, v2, n2, n, counts);
+	return fromCounts(counts, n1, n2, n);
+}
+
+/// <summary> Build the bit planes of a vector of states : the bit \f$ i \f$ of the plane \f$ s \f$ is set if the sample \f$ i \f$ is in state \f$ s \f$. </summary>
+/// <param name="v">The states (in \f$ [0, n_{states}[ \f$).</param>
+/// <param name="nStates">The number of states.</param>
+/// <param name="n">The number of samples.</param>
+/// <param name="planes">The planes (\f$ n_{states} \f$ planes of <see cref="nWords"/> words, must be filled with 0).</param>
+/// <param name="counts">The number of samples in each state (the popcount of each plane).</param>
+template <typename T>
+void buildBitPlanes(const T* v, const size_t nStates, const size_t n, uint64_t* planes, size_t* counts)
+{
+	const size_t words = nWords(n);
+	for (size_t s = 0; s < nStates; ++s) { counts[s] = 0; }
+	for (size_t i = 0; i < n; ++i)
+	{
+		planes[size_t(v[i]) * words + i / 64] |= uint64_t(1) << (i % 64);
+		counts[size_t(v[i])]++;
+	}
+}
+
+/// <summary> Joint counts of two variables encoded in bit planes. </summary>
+/// Each joint count is the popcount of the AND of two planes. The last row and the last column of the joint counts are deduced from the counts of each plane.
+/// <param name="p1">The planes of the first variable.</param>
+/// <param name="c1">The counts of each state of the first variable.</param>
+/// <param name="n1">The number of states of the first variable.</param>
+/// <param name="p2">The planes of the second variable.</param>
+/// <param name="c2">The counts of each state of the second variable.</param>
+/// <param name="n2">The number of states of the second variable.</param>
+/// <param name="n">The number of samples.</param>
+/// <param name="counts">The joint counts (row major \f$ n_1 \times n_2 \f$).</param>
+void bitPlanesCounts(const uint64_t* p1, const size_t* c1, const size_t n1, const uint64_t* p2, const size_t* c2, const size_t n2, const size_t n, std::vector<double>& counts);
+
+/// <summary> Mutual information between two variables encoded in bit planes (see <see cref="bitPlanesCounts"/>). </summary>
+/// <param name="p1">The planes of the first variable.</param>
+/// <param name="c1">The counts of each state of the first variable.</param>
+/// <param name="n1">The number of states of the first variable.</param>
+/// <param name="p2">The planes of the second variable.</param>
+/// <param name="c2">The counts of each state of the second variable.</param>
+/// <param name="n2">The number of states of the second variable.</param>
+/// <param name="n">The number of samples.</param>
+/// <returns> the mutal information. </returns>
+double bitPlanes(const uint64_t* p1, const size_t* c1, const size_t n1, const uint64_t* p2, const size_t* c2, const size_t n2, const size_t n);
+}	// namespace MutualInfo
@@ -0,0 +1,249 @@
+///-------------------------------------------------------------------------------------------------
+///
+/// \file benchmark_mRMR.cpp
+/// \brief Benchmarks of the mRMR (minimum Redundancy Maximum Relevance Feature Selection) on synthetic datas.
+/// \author Thibaut Monseigne (Inria).
+/// \version 1.0.
+/// \date 17/10/2026.
+/// \copyright <a href="https://choosealicense.com/licenses/agpl-3.0/">GNU Affero General Public License v3.0</a>.
+/// \remarks
+/// - The datas are generated with a fixed seed, so two versions of the library are compared on the same datas.
+/// - The results are written in JSON by default (benchmark.json), other Google Benchmark options can be used (e.g. --benchmark_filter=process).
+///
+///-------------------------------------------------------------------------------------------------
+
+#include <benchmark/benchmark.h>
+#include "CMRMR.hpp"
+#include "MutualInfo.hpp"
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+
+namespace
+{
+/// <summary> Configuration of a synthetic dataset. </summary>
+struct SSynthetic
+{
+	size_t nSamples    = 1000;	// Number of samples
+	size_t nFeatures   = 1000;	// Number of features
+	size_t nClasses    = 4;		// Number of classes
+	double informative = 0.05;	// Ratio of features which depend on the class
+	uint32_t seed      = 42;	// Seed of the generator
+
+	bool operator<(const SSynthetic& c) const
+	{
+		return std::tie(nSamples, nFeatures, nClasses, informative, seed) < std::tie(c.nSamples, c.nFeatures, c.nClasses, c.informative, c.seed);
+	}
+};
+
+/// <summary> Synthetic dataset (samples -> features, as setDatas). </summary>
+struct SDataset
+{
+	std::vector<std::vector<double>> datas;
+	std::vector<int> classes;
+};
+
+/// <summary> Generate a synthetic dataset. </summary>
+/// The informative features are gaussian with a mean which depends on the class (and a feature specific gain), the other features are gaussian noise.
+/// <param name="config">The configuration.</param>
+/// <returns> The dataset (generated once by configuration). </returns>
+const SDataset& dataset(const SSynthetic& config)
+{
+	static std::map<SSynthetic, SDataset> cache;
+	auto it = cache.find(config);
+	if (it != cache.end()) { return it->second; }
+
+	std::mt19937 gen(config.seed);
+	std::normal_distribution<double> noise(0.0, 1.0);
+	std::uniform_real_distribution<double> gain(0.2, 1.0);
+	const size_t nInformative = size_t(config.informative * double(config.nFeatures));
+	std::vector<double> gains(config.nFeatures, 0.0);
+	for (size_t j = 0; j < nInformative; ++j) { gains[(j * config.nFeatures) / nInformative] = gain(gen); }	// Informative features are spread
+
+	SDataset res;
+	res.classes.resize(config.nSamples);
+	res.datas.assign(config.nSamples, std::vector<double>(config.nFeatures));
+	for (size_t i = 0; i < config.nSamples; ++i)
+	{
+		const int classId = int(gen() % config.nClasses) + 1;
+		res.classes[i]    = classId;
+		for (size_t j = 0; j < config.nFeatures; ++j) { res.datas[i][j] = gains[j] * double(classId) + noise(gen); }
+	}
+	return cache.emplace(config, std::move(res)).first->second;
+}
+
+/// <summary> Write a synthetic dataset in a CSV file (same format as the files read by <see cref="CMRMR::readCSV"/>). </summary>
+/// <param name="filename">The filename.</param>
+/// <param name="set">The dataset.</param>
+void writeCSV(const std::string& filename, const SDataset& set)
+{
+	std::ofstream file(filename);
+	file << "class";
+	for (size_t j = 0; j < set.datas.front().size(); ++j) { file << ",v" << j + 1; }
+	file << "\n";
+	for (size_t i = 0; i < set.datas.size(); ++i)
+	{
+		file << set.classes[i];
+		for (const double v : set.datas[i]) { file << "," << v; }
+		file << "\n";
+	}
+}
+
+/// <summary> Random encoded states (for the mutual information kernels). </summary>
+std::vector<uint8_t> randomStates(const size_t n, const size_t nStates, const uint32_t seed)
+{
+	std::mt19937 gen(seed);
+	std::vector<uint8_t> res(n);
+	for (auto& v : res) { v = uint8_t(gen() % nStates); }
+	return res;
+}
+
+/// <summary> Threshold of the benchmark argument (0 for infinity). </summary>
+double threshold(const int64_t arg) { return (arg == 0) ? std::numeric_limits<double>::infinity() : double(arg) / 10.0; }
+}	// namespace
+
+///-------------------------------------------------------------------------------------------------
+/// Read a CSV file (Args : samples, features, threads)
+static void BM_readCSV(benchmark::State& state)
+{
+	SSynthetic config;
+	config.nSamples  = size_t(state.range(0));
+	config.nFeatures = size_t(state.range(1));
+	const std::string filename = "benchmark_" + std::to_string(config.nSamples) + "x" + std::to_string(config.nFeatures) + ".csv";
+	writeCSV(filename, dataset(config));
+	for (auto _ : state)
+	{
+		CMRMR data;
+		benchmark::DoNotOptimize(data.readCSV(filename, size_t(state.range(2))));
+	}
+	std::remove(filename.c_str());
+	state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_readCSV)->Args({ 1000, 1000, 1 })->Args({ 1000, 1000, 0 })->Args({ 5000, 2000, 0 })->Unit(benchmark::kMillisecond);
+
+///-------------------------------------------------------------------------------------------------
+/// Z-score and discretization of all features, without selection (Args : threshold x 10 (0 for infinity), samples, features)
+static void BM_encode(benchmark::State& state)
+{
+	SSynthetic config;
+	config.nSamples  = size_t(state.range(1));
+	config.nFeatures = size_t(state.range(2));
+	CMRMR base;
+	base.setDatas(dataset(config).datas, dataset(config).classes);
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		CMRMR data = base;	// Not encoded
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(data.process(threshold(state.range(0)), 0));
+	}
+	state.SetItemsProcessed(int64_t(state.iterations()) * state.range(1) * state.range(2));
+}
+BENCHMARK(BM_encode)->Args({ 5, 1000, 1000 })->Args({ 0, 1000, 1000 })->Args({ 5, 10000, 1000 })->Unit(benchmark::kMillisecond);
+
+///-------------------------------------------------------------------------------------------------
+/// One mutual information with the generic kernel (Args : samples, states)
+static void BM_mutualInfoGeneric(benchmark::State& state)
+{
+	const size_t n = size_t(state.range(0)), nStates = size_t(state.range(1));
+	const std::vector<uint8_t> v1 = randomStates(n, nStates, 1), v2 = randomStates(n, nStates, 2);
+	for (auto _ : state) { benchmark::DoNotOptimize(MutualInfo::generic(v1.data(), nStates, v2.data(), nStates, n)); }
+	state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_mutualInfoGeneric)->Args({ 1000, 3 })->Args({ 100000, 2 })->Args({ 100000, 3 })->Args({ 100000, 4 })->Args({ 100000, 5 })->Args({ 100000, 6 })->Args({ 100000, 8 })->Args({ 100000, 32 });
+
+///-------------------------------------------------------------------------------------------------
+/// One mutual information with the bit planes kernel (Args : samples, states)
+static void BM_mutualInfoBitPlanes(benchmark::State& state)
+{
+	const size_t n = size_t(state.range(0)), nStates = size_t(state.range(1)), words = MutualInfo::nWords(n);
+	const std::vector<uint8_t> v1 = randomStates(n, nStates, 1), v2 = randomStates(n, nStates, 2);
+	std::vector<uint64_t> p1(nStates * words), p2(nStates * words);
+	std::vector<size_t> c1(nStates), c2(nStates);
+	MutualInfo::buildBitPlanes(v1.data(), nStates, n, p1.data(), c1.data());
+	MutualInfo::buildBitPlanes(v2.data(), nStates, n, p2.data(), c2.data());
+	for (auto _ : state) { benchmark::DoNotOptimize(MutualInfo::bitPlanes(p1.data(), c1.data(), nStates, p2.data(), c2.data(), nStates, n)); }
+	state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_mutualInfoBitPlanes)->Args({ 1000, 3 })->Args({ 100000, 2 })->Args({ 100000, 3 })->Args({ 100000, 4 })->Args({ 100000, 5 })->Args({ 100000, 6 })->Args({ 100000, 8 });
+
+///-------------------------------------------------------------------------------------------------
+/// Relevance of all features with codes already computed, 16 states by feature (Args : samples, features)
+static void BM_relevance(benchmark::State& state)
+{
+	SSynthetic config;
+	config.nSamples  = size_t(state.range(0));
+	config.nFeatures = size_t(state.range(1));
+	CMRMR base;
+	base.setDatas(dataset(config).datas, dataset(config).classes);
+	base.setBinning(EBinning::EqualWidth, 16);
+	base.process(std::numeric_limits<double>::infinity(), 1);	// Encoded once
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		CMRMR data = base;
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(data.process(std::numeric_limits<double>::infinity(), 1));
+	}
+	state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_relevance)->Args({ 1000, 2000 })->Args({ 20000, 2000 })->Unit(benchmark::kMillisecond);
+
+///-------------------------------------------------------------------------------------------------
+/// Complete process, encoding included (Args : number of selected features K, threads, samples, features)
+static void BM_process(benchmark::State& state)
+{
+	SSynthetic config;
+	config.nSamples  = size_t(state.range(2));
+	config.nFeatures = size_t(state.range(3));
+	CMRMR base;
+	base.setDatas(dataset(config).datas, dataset(config).classes);
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		CMRMR data = base;
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(data.process(0.5, size_t(state.range(0)), EMRMRMethod::MID, size_t(state.range(1))));
+	}
+}
+BENCHMARK(BM_process)->ArgsProduct({ { 10, 50, 200 }, { 1, 0 }, { 1000 }, { 2000 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_process)->Args({ 50, 0, 10000, 5000 })->Unit(benchmark::kMillisecond);
+
+///-------------------------------------------------------------------------------------------------
+/// Complete process with the pruned search of the candidates (Args : number of selected features K, threads, samples, features)
+static void BM_processPruned(benchmark::State& state)
+{
+	SSynthetic config;
+	config.nSamples  = size_t(state.range(2));
+	config.nFeatures = size_t(state.range(3));
+	CMRMR base;
+	base.setDatas(dataset(config).datas, dataset(config).classes);
+	base.setPruning(true);
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		CMRMR data = base;
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(data.process(0.5, size_t(state.range(0)), EMRMRMethod::MID, size_t(state.range(1))));
+	}
+}
+BENCHMARK(BM_processPruned)->ArgsProduct({ { 10, 50, 200 }, { 1, 0 }, { 1000 }, { 2000 } })->Unit(benchmark::kMillisecond);
+
+///-------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	// JSON output by default (added before the user arguments, so they can override it)
+	std::vector<char*> args(argv, argv + argc);
+	std::string out = "--benchmark_out=benchmark.json", format = "--benchmark_out_format=json";
+	args.insert(args.begin() + 1, { &out[0], &format[0] });
+	int n = int(args.size());
+	benchmark::Initialize(&n, args.data());
+	if (benchmark::ReportUnrecognizedArguments(n, args.data())) { return 1; }
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,267 @@
+///-------------------------------------------------------------------------------------------------
+///
+/// \file cli_mRMR.cpp
+/// \brief Command line tool to apply the mRMR (minimum Redundancy Maximum Relevance Feature Selection) on many CSV files.
+/// \author Thibaut Monseigne (Inria).
+/// \version 1.0.
+/// \date 17/10/2026.
+/// \copyright <a href="https://choosealicense.com/licenses/agpl-3.0/">GNU Affero General Public License v3.0</a>.
+/// \remarks
+/// - The files are parsed by reader threads and selected by selector threads, a bounded queue between them keeps a few parsed files in memory.
+/// - The reading of the next files overlaps the selections, each selection uses one thread so the throughput scales with the files.
+/// - One line is written by file in the order of the files : the filename, a tabulation and the selected indexes separated by commas (or the error).
+///
+///-------------------------------------------------------------------------------------------------
+
+#include "CMRMR.hpp"
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/// <summary> Options of the command line. </summary>
+struct SOptions
+{
+	double threshold   = std::numeric_limits<double>::infinity();	// The threshold for discretization
+	size_t nFeatures   = 500;										// The number of features to keep
+	EMRMRMethod method = EMRMRMethod::MID;							// Method Used for mRMR
+	size_t nThreads    = 0;											// Number of threads (0 for all hardware threads)
+	size_t nReaders    = 0;											// Number of reader threads (0 for a quarter of the threads)
+	size_t queue       = 0;											// Number of parsed files waiting for a selector (0 for twice the selectors)
+	std::string output;												// Output file (standard output if empty)
+	std::vector<std::string> files;									// Files to process
+};
+
+/// <summary> A parsed file waiting for its selection. </summary>
+struct SParsed
+{
+	size_t index = 0;				// Index of the file
+	std::unique_ptr<CMRMR> datas;	// The datas (nullptr if the file can't be read)
+};
+
+/// <summary> Queue with a capacity : a producer waits when the queue is full and a consumer waits when the queue is empty. </summary>
+template <typename T>
+class CBoundedQueue
+{
+public:
+	/// <summary> Initializes a new instance of the <see cref="CBoundedQueue"/> class. </summary>
+	/// <param name="capacity">The maximum number of elements.</param>
+	explicit CBoundedQueue(const size_t capacity) : m_capacity(capacity) {}
+
+	/// <summary> Add an element (wait while the queue is full). </summary>
+	/// <param name="value">The element.</param>
+	void push(T value)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_notFull.wait(lock, [this] { return m_values.size() < m_capacity; });
+		m_values.push_back(std::move(value));
+		m_notEmpty.notify_one();
+	}
+
+	/// <summary> Take the first element (wait while the queue is empty and not closed). </summary>
+	/// <param name="value">The element.</param>
+	/// <returns> False if the queue is closed and empty. </returns>
+	bool pop(T& value)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_notEmpty.wait(lock, [this] { return !m_values.empty() || m_closed; });
+		if (m_values.empty()) { return false; }
+		value = std::move(m_values.front());
+		m_values.pop_front();
+		m_notFull.notify_one();
+		return true;
+	}
+
+	/// <summary> No more element will be added, the consumers stop when the queue is empty. </summary>
+	void close()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_closed = true;
+		m_notEmpty.notify_all();
+	}
+
+private:
+	const size_t m_capacity;
+	std::deque<T> m_values;
+	bool m_closed = false;
+	std::mutex m_mutex;
+	std::condition_variable m_notFull, m_notEmpty;
+};
+
+/// <summary> Write the result lines in the order of the files (a line waits for the previous ones). </summary>
+class COrderedOutput
+{
+public:
+	/// <summary> Initializes a new instance of the <see cref="COrderedOutput"/> class. </summary>
+	/// <param name="os">The stream.</param>
+	explicit COrderedOutput(std::ostream& os) : m_os(os) {}
+
+	/// <summary> Add the line of a file. </summary>
+	/// <param name="index">The index of the file.</param>
+	/// <param name="line">The line (without end of line).</param>
+	void write(const size_t index, std::string line)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_waiting.emplace(index, std::move(line));
+		for (auto it = m_waiting.begin(); it != m_waiting.end() && it->first == m_next; it = m_waiting.erase(it), ++m_next) { m_os << it->second << '\n'; }
+		m_os.flush();
+	}
+
+private:
+	std::ostream& m_os;
+	std::map<size_t, std::string> m_waiting;	// Lines of the files after a missing one
+	size_t m_next = 0;							// Index of the next line to write
+	std::mutex m_mutex;
+};
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Print the usage. </summary>
+void usage(const char* name)
+{
+	std::cerr << "Usage : " << name << " [options] file... (or --list file)\n"
+			<< "  -t, --threshold <value>  Threshold for discretization, inf to use the z-score only (default inf)\n"
+			<< "  -k, --features <n>       Number of features to keep (default 500, 0 for an empty selection)\n"
+			<< "  -m, --method <MID|MIQ>   Method used for mRMR (default MID)\n"
+			<< "  -j, --threads <n>        Number of threads, 0 for all hardware threads (default 0)\n"
+			<< "  -r, --readers <n>        Number of reader threads (default a quarter of the threads)\n"
+			<< "  -q, --queue <n>          Number of parsed files waiting for a selection (default twice the selectors)\n"
+			<< "  -l, --list <file>        File with one CSV file by line\n"
+			<< "  -o, --output <file>      Output file (default standard output)\n";
+}
+///-------------------------------------------------------------------------------------------------
+
+///-------------------------------------------------------------------------------------------------
+/// <summary> Parse the command line. </summary>
+/// <returns> True if success, False if fail (unknown option or bad value). </returns>
+bool parse(const int argc, char** argv, SOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg.empty() || arg[0] != '-')
+		{
+			options.files.push_back(arg);
+			continue;
+		}
+		if (i + 1 >= argc) { return false; }
+		const std::string value = argv[++i];
+		try
+		{
+			if (arg == "-t" || arg == "--threshold") { options.threshold = (value == "inf") ? std::numeric_limits<double>::infinity() : std::stod(value); }
+			else if (arg == "-k" || arg == "--features") { options.nFeatures = size_t(std::stoull(value)); }
+			else if (arg == "-j" || arg == "--threads") { options.nThreads = size_t(std::stoull(value)); }
+			else if (arg == "-r" || arg == "--readers") { options.nReaders = size_t(std::stoull(value)); }
+			else if (arg == "-q" || arg == "--queue") { options.queue = size_t(std::stoull(value)); }
+			else if (arg == "-o" || arg == "--output") { options.output = value; }
+			else if (arg == "-m" || arg == "--method")
+			{
+				if (value == "MID") { options.method = EMRMRMethod::MID; }
+				else if (value == "MIQ") { options.method = EMRMRMethod::MIQ; }
+				else { return false; }
+			}
+			else if (arg == "-l" || arg == "--list")
+			{
+				std::ifstream list(value);
+				if (!list.is_open()) { return false; }
+				for (std::string line; std::getline(list, line);)
+				{
+					if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+					if (!line.empty()) { options.files.push_back(line); }
+				}
+			}
+			else { return false; }
+		}
+		catch (std::exception&) { return false; }
+	}
+	return !options.files.empty();
+}
+///-------------------------------------------------------------------------------------------------
+}	// namespace
+
+int main(int argc, char** argv)
+{
+	SOptions options;
+	if (!parse(argc, argv, options))
+	{
+		usage(argv[0]);
+		return 2;
+	}
+
+	// Threads : the readers parse the next files while the selectors process the parsed ones
+	const size_t nThreads   = (options.nThreads != 0) ? options.nThreads : std::max(1u, std::thread::hardware_concurrency());
+	const size_t nReaders   = std::min(options.files.size(), (options.nReaders != 0) ? options.nReaders : std::max(size_t(1), nThreads / 4));
+	const size_t nSelectors = std::min(options.files.size(), std::max(size_t(1), nThreads - std::min(nThreads - 1, nReaders)));
+	CBoundedQueue<SParsed> parsed((options.queue != 0) ? options.queue : 2 * nSelectors);
+
+	std::ofstream file;
+	if (!options.output.empty())
+	{
+		file.open(options.output);
+		if (!file.is_open())
+		{
+			std::cerr << "Output file cannot be opened : " << options.output << std::endl;
+			return 2;
+		}
+	}
+	COrderedOutput output(options.output.empty() ? std::cout : file);
+
+	std::mutex nextMutex;
+	size_t next = 0;	// Next file to read
+	std::vector<std::thread> readers, selectors;
+	for (size_t r = 0; r < nReaders; ++r)
+	{
+		readers.emplace_back([&]
+		{
+			for (;;)
+			{
+				SParsed item;
+				{
+					std::lock_guard<std::mutex> lock(nextMutex);
+					if (next == options.files.size()) { return; }
+					item.index = next++;
+				}
+				item.datas = std::make_unique<CMRMR>();
+				if (!item.datas->readCSV(options.files[item.index])) { item.datas.reset(); }
+				parsed.push(std::move(item));
+			}
+		});
+	}
+
+	std::mutex failedMutex;
+	size_t failed = 0;
+	for (size_t s = 0; s < nSelectors; ++s)
+	{
+		selectors.emplace_back([&]
+		{
+			for (SParsed item; parsed.pop(item);)
+			{
+				std::string line = options.files[item.index] + '\t';
+				const bool read                     = item.datas != nullptr;
+				const std::vector<size_t> selection = read ? item.datas->process(options.threshold, options.nFeatures, options.method) : std::vector<size_t>();
+				item.datas.reset();	// The memory of the datas is released before the next file
+				if (!read || (selection.empty() && options.nFeatures != 0))	// Unreadable file or encoding failure (no feature is kept with -k 0)
+				{
+					line += "error";
+					std::lock_guard<std::mutex> lock(failedMutex);
+					failed++;
+				}
+				for (size_t k = 0; k < selection.size(); ++k) { line += (k == 0 ? "" : ",") + std::to_string(selection[k]); }
+				output.write(item.index, line);
+			}
+		});
+	}
+
+	for (auto& t : readers) { t.join(); }
+	parsed.close();
+	for (auto& t : selectors) { t.join(); }
+	return (failed == 0) ? 0 : 1;
+}
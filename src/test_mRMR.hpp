@@ -15,6 +15,16 @@
 
 #include "gtest/gtest.h"
 #include "CMRMR.hpp"
+#include "CMRMRStats.hpp"
+#include "CSocket.hpp"
+#include "MutualInfo.hpp"
+#include <algorithm>
+#include <random>
+#include <numeric>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <thread>
 
 #ifdef _WIN32
 const std::string FILENAME = "res/test_lung_s3.csv";		// With SLN we are on root folder
@@ -142,3 +152,829 @@ TEST_F(Test_mRMRM, process9)
 	};
 	EXPECT_TRUE(ref == calc) << ErrorMsg("Process 9, threshold = 0, nFeatures = 500, method = MIQ", ref, calc).str();
 }
+
+TEST_F(Test_mRMRM, processTwice)
+{
+	m_data.process(0, 10, EMRMRMethod::MID);
+	const std::vector<size_t> calc = m_data.process(std::numeric_limits<double>::infinity(), 10, EMRMRMethod::MID);
+	const std::vector<size_t> ref  = { 22, 125, 243, 132, 242, 29, 150, 166, 18, 269 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Process twice, no discretization after threshold = 0, nFeatures = 10, method = MID", ref, calc).str();
+}
+
+TEST_F(Test_mRMRM, processThreads1)
+{
+	const std::vector<size_t> calc = m_data.process(0, 10, EMRMRMethod::MID, 4);
+	const std::vector<size_t> ref  = { 230, 98, 242, 22, 181, 171, 82, 6, 248, 10 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Process threads 1, threshold = 0, nFeatures = 10, method = MID, nThreads = 4", ref, calc).str();
+}
+
+TEST_F(Test_mRMRM, processThreads2)
+{
+	const std::vector<size_t> calc = m_data.process(std::numeric_limits<double>::infinity(), 10, EMRMRMethod::MIQ, 0);
+	const std::vector<size_t> ref  = { 22, 139, 274, 104, 234, 33, 145, 105, 261, 41 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Process threads 2, no discretization, nFeatures = 10, method = MIQ, nThreads = all", ref, calc).str();
+}
+
+TEST_F(Test_mRMRM, processPruning)
+{
+	CMRMR pruned = m_data;
+	CMRMRStats stats, prunedStats;
+	m_data.setStats(&stats);
+	pruned.setStats(&prunedStats);
+	pruned.setPruning(true);
+	for (const double threshold : { 0.0, 0.5, std::numeric_limits<double>::infinity() })
+	{
+		for (const EMRMRMethod method : { EMRMRMethod::MID, EMRMRMethod::MIQ })
+		{
+			const std::vector<size_t> ref = m_data.process(threshold, 50, method);
+			for (const size_t nThreads : { 1, 4 })
+			{
+				const std::vector<size_t> calc = pruned.process(threshold, 50, method, nThreads);
+				EXPECT_TRUE(ref == calc) << ErrorMsg("Pruning, threshold = " + std::to_string(threshold) + ", " + std::to_string(nThreads) + " threads", ref, calc).str();
+			}
+		}
+	}
+	EXPECT_LT(prunedStats.redundancyCalls(), 2 * stats.redundancyCalls());	// Two pruned process for each process
+}
+
+TEST_F(Test_mRMRM, processBatch)
+{
+	std::vector<CMRMR::SProcessConfig> configs;
+	for (const double threshold : { 0.0, 0.5, std::numeric_limits<double>::infinity() })
+	{
+		for (const EMRMRMethod method : { EMRMRMethod::MID, EMRMRMethod::MIQ })
+		{
+			for (const size_t nFeatures : { 50, 10, 0 }) { configs.push_back({ threshold, nFeatures, method }); }
+		}
+	}
+	std::swap(configs[1], configs.back());	// Thresholds are not sorted
+
+	CMRMR data = m_data;
+	CMRMRStats stats;
+	data.setStats(&stats);
+	const std::vector<std::vector<size_t>> calc = data.processBatch(configs, 2);
+	ASSERT_EQ(calc.size(), configs.size());
+	for (size_t i = 0; i < configs.size(); ++i)
+	{
+		const std::vector<size_t> ref = m_data.process(configs[i].threshold, configs[i].nFeatures, configs[i].method);
+		EXPECT_TRUE(ref == calc[i]) << ErrorMsg("Batch " + std::to_string(i), ref, calc[i]).str();
+	}
+	EXPECT_GT(stats.cachedCalls(), 0u);
+	EXPECT_TRUE(data.process(0, 10, EMRMRMethod::MID) == calc.back());	// Same object after the batch
+}
+
+TEST_F(Test_mRMRM, readCSVThreads)
+{
+	CMRMR data;
+	EXPECT_TRUE(data.readCSV(FILENAME, 4));
+	EXPECT_EQ(m_data.print(), data.print());
+	const std::vector<size_t> calc = data.process(0, 10, EMRMRMethod::MIQ);
+	const std::vector<size_t> ref  = { 230, 139, 140, 6, 304, 234, 276, 261, 145, 142 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Read CSV with 4 threads, threshold = 0, nFeatures = 10, method = MIQ", ref, calc).str();
+}
+
+TEST(Test_mRMR, readCSVFormat)
+{
+	const std::string filename = "test_format.csv";
+	CMRMR data;
+	{	// Windows end of line, blanks and no end of line at the end of file
+		std::ofstream file(filename, std::ios::binary);
+		file << "class,v1,v2\r\n1, 2.5,-1e2\r\n+2,0,3 \r\n1,1,1";
+	}
+	EXPECT_TRUE(data.readCSV(filename));
+	EXPECT_EQ(data.print(), "Datas contain 2 Features, with 3 samples, for 2 Classes (Class 0 : id(1), 2 samples, Class 1 : id(2), 1 samples).\n"
+							"Datas are not z-scored and discretize.\n");
+	{	// Bad number of separators
+		std::ofstream file(filename, std::ios::binary);
+		file << "class,v1,v2\n1,2,3\n1,2\n1,2,3,4\n";
+	}
+	testing::internal::CaptureStderr();
+	EXPECT_FALSE(data.readCSV(filename, 2));
+	EXPECT_EQ(testing::internal::GetCapturedStderr(), "not same number of features : 1expected : 2\n");
+	EXPECT_EQ(data.print(), "Datas contain 0 Features, with 0 samples, for 0 Classes ().\nDatas are not z-scored and discretize.\n");
+	{	// Bad value
+		std::ofstream file(filename, std::ios::binary);
+		file << "class,v1,v2\n1,2,3\n1,2,x\n";
+	}
+	testing::internal::CaptureStderr();
+	EXPECT_FALSE(data.readCSV(filename));
+	EXPECT_EQ(testing::internal::GetCapturedStderr(), "not found good number of features : 1expected : 2\n");
+	std::remove(filename.c_str());
+}
+
+/// <summary> Read the rows of the CSV test file (class, values). </summary>
+inline void readRows(std::vector<std::vector<double>>& datas, std::vector<int>& classes)
+{
+	std::ifstream file(FILENAME);
+	std::string line;
+	std::getline(file, line);
+	while (std::getline(file, line))
+	{
+		std::stringstream ss(line);
+		int classId;
+		double value;
+		char sep;
+		ss >> classId;
+		classes.push_back(classId);
+		datas.emplace_back();
+		while (ss >> sep >> value) { datas.back().push_back(value); }
+	}
+}
+
+TEST(Test_mRMR, setDatas)
+{
+	std::vector<std::vector<double>> datas;
+	std::vector<int> classes;
+	readRows(datas, classes);
+	ASSERT_EQ(datas.size(), 73u);
+	CMRMR data;
+	EXPECT_TRUE(data.setDatas(std::vector<std::vector<double>>(datas.begin(), datas.begin() + 10), std::vector<int>(classes.begin(), classes.begin() + 10)));
+	for (size_t i = 10; i < 20; ++i) { EXPECT_TRUE(data.addSample(datas[i], classes[i])); }
+	EXPECT_TRUE(data.addDatas(std::vector<std::vector<double>>(datas.begin() + 20, datas.end()), std::vector<int>(classes.begin() + 20, classes.end())));
+	const std::vector<size_t> calc = data.process(0, 10, EMRMRMethod::MID);
+	const std::vector<size_t> ref  = { 230, 98, 242, 22, 181, 171, 82, 6, 248, 10 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Set datas, threshold = 0, nFeatures = 10, method = MID", ref, calc).str();
+}
+
+TEST(Test_mRMR, stability)
+{
+	std::vector<std::vector<double>> datas;
+	std::vector<int> classes;
+	readRows(datas, classes);
+	ASSERT_EQ(datas.size(), 73u);
+
+	// Bootstrap subsets (with repeated samples) and cross validation folds
+	std::mt19937 gen(7);
+	std::vector<std::vector<size_t>> subsets(8);
+	for (size_t s = 0; s < 4; ++s) { for (size_t i = 0; i < 73; ++i) { subsets[s].push_back(gen() % 73); } }
+	for (size_t s = 4; s < 8; ++s) { for (size_t i = 0; i < 73; ++i) { if (i % 4 != s - 4) { subsets[s].push_back(i); } } }
+
+	CMRMR data;
+	EXPECT_TRUE(data.setDatas(datas, classes));
+	const double inf                 = std::numeric_limits<double>::infinity();
+	const CMRMR::SStability calc     = data.stability(subsets, inf, 10, EMRMRMethod::MID, 4);
+	const CMRMR::SStability single   = data.stability(subsets, inf, 10, EMRMRMethod::MID, 1);
+	ASSERT_EQ(calc.selections.size(), subsets.size());
+	EXPECT_TRUE(calc.selections == single.selections);
+	double sum = 0;
+	for (const auto& f : calc.frequencies) { sum += f; }
+	EXPECT_DOUBLE_EQ(sum, 10.0);
+
+	// Same selection as a copy of the samples of each subset
+	for (size_t s = 0; s < subsets.size(); ++s)
+	{
+		std::vector<std::vector<double>> subDatas;
+		std::vector<int> subClasses;
+		for (const auto& i : subsets[s])
+		{
+			subDatas.push_back(datas[i]);
+			subClasses.push_back(classes[i]);
+		}
+		CMRMR copy;
+		EXPECT_TRUE(copy.setDatas(subDatas, subClasses));
+		const std::vector<size_t> ref = copy.process(inf, 10, EMRMRMethod::MID);
+		EXPECT_TRUE(ref == calc.selections[s]) << ErrorMsg("Stability, subset " + std::to_string(s), ref, calc.selections[s]).str();
+	}
+	EXPECT_TRUE(data.stability({ { 0, 73 } }, inf, 10).selections.empty());
+
+	// The padding of a small subset and the empty subsets are not counted
+	const CMRMR::SStability small = data.stability({ { 0, 1, 2 }, {} }, inf, 10);
+	ASSERT_EQ(small.frequencies.size(), datas[0].size());
+	for (const auto& f : small.frequencies) { EXPECT_TRUE(f == 0.0 || f == 1.0); }
+	EXPECT_TRUE(data.stability({}, inf, 10).frequencies.empty());
+}
+
+TEST(Test_mRMR, sparseDatas)
+{
+	std::vector<std::vector<double>> datas;
+	std::vector<int> classes;
+	readRows(datas, classes);
+	ASSERT_EQ(datas.size(), 73u);
+	const size_t nFeatures = datas[0].size();
+
+	// Only the positive values are kept (most values become 0), the non-zero values are kept in CSR (by sample) and CSC (by feature) formats
+	for (auto& row : datas) { for (auto& v : row) { if (v < 0) { v = 0; } } }
+	std::vector<size_t> rowOffsets(1, 0), colOffsets(1, 0), features, samples;
+	std::vector<double> rowValues, colValues;
+	for (const auto& row : datas)
+	{
+		for (size_t j = 0; j < nFeatures; ++j)
+		{
+			if (row[j] == 0) { continue; }
+			features.push_back(j);
+			rowValues.push_back(row[j]);
+		}
+		rowOffsets.push_back(features.size());
+	}
+	for (size_t j = 0; j < nFeatures; ++j)
+	{
+		for (size_t i = 0; i < datas.size(); ++i)
+		{
+			if (datas[i][j] == 0 && i % 10 != 0) { continue; }	// Some explicit zeros
+			samples.push_back(i);
+			colValues.push_back(datas[i][j]);
+		}
+		colOffsets.push_back(samples.size());
+	}
+	ASSERT_LT(rowValues.size(), datas.size() * nFeatures / 2);
+
+	CMRMR dense, csr, csc;
+	EXPECT_TRUE(dense.setDatas(datas, classes));
+	EXPECT_TRUE(csr.setSparseDatas(ESparseFormat::CSR, nFeatures, rowOffsets, features, rowValues, classes));
+	EXPECT_TRUE(csc.setSparseDatas(ESparseFormat::CSC, nFeatures, colOffsets, samples, colValues, classes));
+	for (const double threshold : { 0.0, std::numeric_limits<double>::infinity() })
+	{
+		for (const EMRMRMethod method : { EMRMRMethod::MID, EMRMRMethod::MIQ })
+		{
+			const std::vector<size_t> ref = dense.process(threshold, 30, method);
+			std::vector<size_t> calc      = csr.process(threshold, 30, method, 2);
+			EXPECT_TRUE(ref == calc) << ErrorMsg("Sparse CSR, threshold = " + std::to_string(threshold), ref, calc).str();
+			calc = csc.process(threshold, 30, method);
+			EXPECT_TRUE(ref == calc) << ErrorMsg("Sparse CSC, threshold = " + std::to_string(threshold), ref, calc).str();
+		}
+	}
+
+	EXPECT_FALSE(csr.addSample(datas[0], classes[0]));
+	EXPECT_FALSE(csr.save("test_sparse.bin"));
+	features[1] = features[0];	// Not sorted
+	EXPECT_FALSE(csr.setSparseDatas(ESparseFormat::CSR, nFeatures, rowOffsets, features, rowValues, classes));
+	EXPECT_FALSE(csr.setSparseDatas(ESparseFormat::CSC, nFeatures + 1, colOffsets, samples, colValues, classes));
+}
+
+TEST(Test_mRMR, processSharded)
+{
+	std::vector<std::vector<double>> datas;
+	std::vector<int> classes;
+	readRows(datas, classes);
+	ASSERT_EQ(datas.size(), 73u);
+
+	// Three workers on localhost with uneven shards of the columns
+	const std::vector<size_t> offsets = { 0, 100, 101, datas[0].size() };
+	std::vector<CMRMR> shards(offsets.size() - 1);
+	for (size_t w = 0; w < shards.size(); ++w)
+	{
+		std::vector<std::vector<double>> columns;
+		for (const auto& row : datas) { columns.emplace_back(row.begin() + offsets[w], row.begin() + offsets[w + 1]); }
+		EXPECT_TRUE(shards[w].setDatas(columns, classes));
+	}
+
+	CMRMR data;
+	EXPECT_TRUE(data.setDatas(datas, classes));
+	for (const double threshold : { 0.0, std::numeric_limits<double>::infinity() })
+	{
+		for (const EMRMRMethod method : { EMRMRMethod::MID, EMRMRMethod::MIQ })
+		{
+			std::vector<CSocket> listeners(shards.size());
+			std::vector<std::pair<std::string, uint16_t>> workers;
+			std::vector<std::thread> threads;
+			for (size_t w = 0; w < shards.size(); ++w)
+			{
+				ASSERT_TRUE(listeners[w].listen(0));
+				workers.emplace_back("127.0.0.1", listeners[w].port());
+				threads.emplace_back([&, w]() { EXPECT_TRUE(shards[w].serve(listeners[w], 2)); });
+			}
+			const std::vector<size_t> calc = CMRMR::processSharded(workers, threshold, 30, method);
+			for (auto& t : threads) { t.join(); }
+			const std::vector<size_t> ref = data.process(threshold, 30, method);
+			EXPECT_TRUE(ref == calc) << ErrorMsg("Sharded, threshold = " + std::to_string(threshold), ref, calc).str();
+		}
+	}
+	EXPECT_TRUE(CMRMR::processSharded({}, 0, 30).empty());
+
+	// A worker rejects a received column without states or with codes out of its states
+	for (const uint64_t nStates : { uint64_t(0), uint64_t(2) })
+	{
+		CSocket listener, coordinator;
+		ASSERT_TRUE(listener.listen(0));
+		std::thread worker([&]() { EXPECT_FALSE(shards[0].serve(listener, 1)); });
+		const uint32_t select = 1;	// EShardMessage::Select
+		const uint64_t feature = uint64_t(-1);
+		const std::vector<uint8_t> column(datas.size(), 2);
+		EXPECT_TRUE(coordinator.connect("127.0.0.1", listener.port()) && coordinator.send(&select, sizeof(select)) && coordinator.send(&feature, sizeof(feature))
+					&& coordinator.send(&nStates, sizeof(nStates)) && coordinator.send(column.data(), column.size()));
+		worker.join();
+	}
+
+	// A worker rejects an unknown method
+	{
+		CSocket listener, coordinator;
+		ASSERT_TRUE(listener.listen(0));
+		std::thread worker([&]() { EXPECT_FALSE(shards[0].serve(listener, 1)); });
+		const uint32_t start = 0;	// EShardMessage::Start
+		const double threshold = 0;
+		const uint64_t method  = 2;
+		EXPECT_TRUE(coordinator.connect("127.0.0.1", listener.port()) && coordinator.send(&start, sizeof(start)) && coordinator.send(&threshold, sizeof(threshold))
+					&& coordinator.send(&method, sizeof(method)));
+		worker.join();
+	}
+}
+
+TEST(Test_mRMR, incremental)
+{
+	std::vector<std::vector<double>> datas;
+	std::vector<int> classes;
+	readRows(datas, classes);
+	ASSERT_EQ(datas.size(), 73u);
+	for (const double threshold : { 0.0, std::numeric_limits<double>::infinity() })
+	{
+		for (const EMRMRMethod method : { EMRMRMethod::MID, EMRMRMethod::MIQ })
+		{
+			CMRMR data;
+			data.setIncremental(true);
+			EXPECT_TRUE(data.setDatas(std::vector<std::vector<double>>(datas.begin(), datas.begin() + 30), std::vector<int>(classes.begin(), classes.begin() + 30)));
+			data.process(threshold, 50, method);
+			for (size_t n = 30; n < datas.size();)
+			{
+				const size_t next = std::min(datas.size(), n + 11);
+				for (; n < next; ++n) { EXPECT_TRUE(data.addSample(datas[n], classes[n])); }
+				CMRMR cold;
+				EXPECT_TRUE(cold.setDatas(std::vector<std::vector<double>>(datas.begin(), datas.begin() + n), std::vector<int>(classes.begin(), classes.begin() + n)));
+				const std::vector<size_t> ref  = cold.process(threshold, 50, method);
+				const std::vector<size_t> calc = data.process(threshold, 50, method);
+				EXPECT_TRUE(ref == calc) << ErrorMsg("Incremental, threshold = " + std::to_string(threshold) + ", " + std::to_string(n) + " samples", ref, calc).str();
+			}
+		}
+	}
+}
+
+TEST(Test_mRMR, addFeatures)
+{
+	std::vector<std::vector<double>> datas;
+	std::vector<int> classes;
+	readRows(datas, classes);
+	ASSERT_EQ(datas.size(), 73u);
+	std::vector<std::vector<double>> first, columns(25);
+	for (const auto& row : datas)
+	{
+		first.emplace_back(row.begin(), row.begin() + 300);
+		for (size_t j = 0; j < columns.size(); ++j) { columns[j].push_back(row[300 + j]); }
+	}
+
+	for (const double threshold : { 0.0, std::numeric_limits<double>::infinity() })
+	{
+		CMRMR data, cold;
+		CMRMRStats stats;
+		data.setIncremental(true);
+		data.setStats(&stats);
+		EXPECT_TRUE(data.setDatas(first, classes));
+		data.process(threshold, 10);
+		EXPECT_TRUE(data.addFeatures(std::vector<std::vector<double>>(columns.begin(), columns.begin() + 10)));
+		EXPECT_TRUE(data.addFeatures(std::vector<std::vector<double>>(columns.begin() + 10, columns.end())));
+		stats.reset();
+		EXPECT_TRUE(cold.setDatas(datas, classes));
+		const std::vector<size_t> ref = cold.process(threshold, 10), calc = data.process(threshold, 10);
+		EXPECT_TRUE(ref == calc) << ErrorMsg("Appended features, threshold = " + std::to_string(threshold), ref, calc).str();
+		EXPECT_GE(stats.cachedCalls(), 300u) << "The relevances of the previous features are kept.";
+	}
+
+	CMRMR data;
+	testing::internal::CaptureStderr();
+	EXPECT_FALSE(data.addFeatures(columns)) << "No samples.";
+	EXPECT_TRUE(data.setDatas(first, classes));
+	EXPECT_FALSE(data.addFeatures({ std::vector<double>(72, 0.0) }));
+	testing::internal::GetCapturedStderr();
+}
+
+TEST(Test_mRMR, binning)
+{
+	// Feature 0 depends on the class with small values and one outlier, other features are noise
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<double> noise(0, 1);
+	std::vector<std::vector<double>> datas;
+	std::vector<int> classes;
+	for (size_t i = 0; i < 200; ++i)
+	{
+		classes.push_back(int(i % 4));
+		datas.push_back({ 0.1 * double(i % 4) + 0.01 * noise(gen), noise(gen), noise(gen), noise(gen) });
+	}
+	datas[0][0] = 1e4;
+
+	CMRMR data;
+	EXPECT_TRUE(data.setDatas(datas, classes));
+	EXPECT_FALSE(data.setBinning(EBinning::EqualWidth, 0));
+	EXPECT_FALSE(data.setBinning(EBinning::EqualFrequency, 257));
+	std::vector<size_t> calc = data.process();
+	EXPECT_EQ(calc.size(), 3u) << "The outlier creates too many states when values are rounded, only this feature is ignored.";
+	EXPECT_TRUE(std::find(calc.begin(), calc.end(), size_t(0)) == calc.end());
+
+	EXPECT_TRUE(data.setBinning(EBinning::EqualFrequency, 4));
+	calc = data.process(std::numeric_limits<double>::infinity(), 4);
+	ASSERT_EQ(calc.size(), 4u);
+	EXPECT_EQ(calc[0], 0u);
+	EXPECT_TRUE(calc == data.process(std::numeric_limits<double>::infinity(), 4, EMRMRMethod::MID, 4));
+
+	EXPECT_TRUE(data.setBinning(EBinning::EqualWidth, 8));
+	calc = data.process(std::numeric_limits<double>::infinity(), 4);
+	EXPECT_EQ(calc.size(), 4u);
+	EXPECT_NE(calc[0], 0u) << "The outlier puts all other values in the first bin.";
+}
+
+TEST(Test_mRMR, relevanceSweep)
+{
+	// Features with 16 states, with few and many classes (the relevances are counted in one sweep, with or without bit planes for the target)
+	std::mt19937 gen(3);
+	std::normal_distribution<double> noise(0.0, 1.0);
+	for (const int nClasses : { 4, 12 })
+	{
+		std::vector<std::vector<double>> datas;
+		std::vector<int> classes;
+		for (size_t i = 0; i < 300; ++i)
+		{
+			classes.push_back(int(i) % nClasses);
+			datas.emplace_back();
+			for (size_t j = 0; j < 263; ++j) { datas.back().push_back(0.2 * double((i % size_t(nClasses)) * (j % 5)) + noise(gen)); }
+		}
+		std::vector<size_t> all(300);
+		std::iota(all.begin(), all.end(), 0);
+
+		CMRMR data;
+		EXPECT_TRUE(data.setDatas(datas, classes));
+		EXPECT_TRUE(data.setBinning(EBinning::EqualWidth, 16));
+		const double inf               = std::numeric_limits<double>::infinity();
+		const std::vector<size_t> ref  = data.stability({ all }, inf, 10).selections[0];	// Mutual infos sample by sample
+		const std::vector<size_t> calc = data.process(inf, 10, EMRMRMethod::MID, 4);
+		EXPECT_TRUE(ref == calc) << ErrorMsg("Sweep, " + std::to_string(nClasses) + " classes", ref, calc).str();
+		data.setIncremental(true);
+		EXPECT_TRUE(ref == data.process(inf, 10)) << "Joint counts kept in the table.";
+		EXPECT_TRUE(ref == data.process(inf, 10)) << "Joint counts of the table.";
+	}
+}
+
+TEST(Test_mRMR, precision)
+{
+	// Values which are not exact in single precision
+	std::mt19937 gen(11);
+	std::normal_distribution<double> noise(0.0, 1.0);
+	std::vector<std::vector<double>> datas, rounded;
+	std::vector<int> classes;
+	for (size_t i = 0; i < 120; ++i)
+	{
+		classes.push_back(int(i % 3));
+		datas.emplace_back();
+		for (size_t j = 0; j < 40; ++j) { datas.back().push_back(0.3 * double((i % 3) * (j % 4)) + noise(gen)); }
+		rounded.emplace_back();
+		for (const auto& v : datas.back()) { rounded.back().push_back(double(float(v))); }
+	}
+
+	CMRMR single, ref;
+	single.setPrecision(EPrecision::Float);
+	EXPECT_TRUE(single.setDatas(datas, classes));
+	EXPECT_TRUE(ref.setDatas(rounded, classes));
+	for (const double threshold : { 0.5, 1.0, std::numeric_limits<double>::infinity() })
+	{
+		const std::vector<size_t> calc = single.process(threshold, 10), expected = ref.process(threshold, 10);
+		EXPECT_TRUE(expected == calc) << ErrorMsg("Float precision, threshold = " + std::to_string(threshold), expected, calc).str();
+	}
+	single.setPrecision(EPrecision::Double);	// Converted without loss
+	EXPECT_TRUE(ref.process(0.5, 10) == single.process(0.5, 10));
+
+	// Raw datas released after the encoding, only the same threshold can be processed
+	CMRMR data;
+	data.setPrecision(EPrecision::Float);
+	data.setReleaseDatas(true);
+	EXPECT_TRUE(data.readCSV(FILENAME));
+	const std::vector<size_t> expected = { 230, 98, 242, 22, 181, 171, 82, 6, 248, 10 };
+	EXPECT_TRUE(expected == data.process(0, 10, EMRMRMethod::MID));
+	EXPECT_TRUE(expected == data.process(0, 10, EMRMRMethod::MID));
+	testing::internal::CaptureStderr();
+	EXPECT_TRUE(data.process(0.5, 10).empty());
+	EXPECT_FALSE(data.addSample(std::vector<double>(325, 0.0), 1));
+	EXPECT_FALSE(data.save("test_released.bin"));
+	testing::internal::GetCapturedStderr();
+}
+
+TEST(Test_mRMR, processProgressive)
+{
+	CMRMR data;
+	EXPECT_TRUE(data.readCSV(FILENAME));
+	const std::vector<size_t> ref = data.process(0, 10, EMRMRMethod::MID, 4);
+
+	// Each feature is given in selection order
+	std::vector<CMRMR::SSelected> given;
+	CMRMR::SProgress progress;
+	progress.callback = [&given](const CMRMR::SSelected& s)
+	{
+		given.push_back(s);
+		return true;
+	};
+	EXPECT_TRUE(ref == data.processProgressive(progress, 0, 10, EMRMRMethod::MID, 4));
+	ASSERT_EQ(given.size(), ref.size());
+	for (size_t i = 0; i < given.size(); ++i)
+	{
+		EXPECT_EQ(given[i].rank, i);
+		EXPECT_EQ(given[i].feature, ref[i]);
+		EXPECT_NEAR(given[i].score, given[i].relevance - given[i].redundancy, 1e-12);
+	}
+
+	// Stopped by the callback or by the cancellation flag, the selection is a prefix
+	progress.callback = [](const CMRMR::SSelected& s) { return s.rank < 2; };
+	EXPECT_TRUE(std::vector<size_t>(ref.begin(), ref.begin() + 3) == data.processProgressive(progress, 0, 10, EMRMRMethod::MID, 4));
+	std::atomic<bool> cancel(false);
+	progress.cancel   = &cancel;
+	progress.callback = [&cancel](const CMRMR::SSelected& s)
+	{
+		if (s.rank == 4) { cancel = true; }
+		return true;
+	};
+	EXPECT_TRUE(std::vector<size_t>(ref.begin(), ref.begin() + 5) == data.processProgressive(progress, 0, 10, EMRMRMethod::MID, 4));
+	EXPECT_TRUE(data.processProgressive(progress, 0, 10).empty()) << "Cancelled before the start.";
+
+	// No time
+	progress.cancel = nullptr;
+	progress.budget = 0;
+	EXPECT_TRUE(data.processProgressive(progress, 0, 10).empty());
+}
+
+TEST(Test_mRMR, stats)
+{
+	CMRMR data;
+	CMRMRStats stats;
+	data.setStats(&stats);
+	EXPECT_TRUE(data.readCSV(FILENAME));
+	EXPECT_GT(stats.time(EPhase::Read), 0.0);
+	const std::vector<size_t> calc = data.process(0, 10, EMRMRMethod::MID);
+	const std::vector<size_t> ref  = { 230, 98, 242, 22, 181, 171, 82, 6, 248, 10 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Stats, threshold = 0, nFeatures = 10, method = MID", ref, calc).str();
+
+	// 325 relevances, then 324 + 323 + ... + 316 redundancies (9 rounds), all with 3 states by feature and 7 classes
+	EXPECT_EQ(stats.relevanceCalls(), 325u);
+	EXPECT_EQ(stats.redundancyCalls(), 2880u);
+	EXPECT_EQ(stats.cachedCalls(), 0u);
+	EXPECT_EQ(stats.histogramCells(), 325u * 21u + 2880u * 9u);
+	EXPECT_EQ(stats.maxHistogramCells(), 21u);
+	EXPECT_GE(stats.peakWorkingSet(), 325 * 73 * sizeof(double));
+	for (const EPhase phase : { EPhase::Encode, EPhase::BitPlanes, EPhase::Relevance, EPhase::Redundancy }) { EXPECT_GT(stats.time(phase), 0.0) << CMRMRStats::toString(phase); }
+	const std::string json = stats.toJSON();
+	EXPECT_NE(json.find("\"relevance\":325,\"redundancy\":2880"), std::string::npos) << json;
+
+	// Without stats, nothing change
+	stats.reset();
+	data.setStats(nullptr);
+	EXPECT_TRUE(ref == data.process(0, 10, EMRMRMethod::MID));
+	EXPECT_EQ(stats.relevanceCalls(), 0u);
+	EXPECT_EQ(stats.time(EPhase::Relevance), 0.0);
+}
+
+TEST(Test_mRMR, candidatePool)
+{
+	CMRMR data;
+	CMRMRStats stats;
+	data.setStats(&stats);
+	EXPECT_TRUE(data.readCSV(FILENAME));
+	const std::vector<size_t> ref = { 230, 98, 242, 22, 181, 171, 82, 6, 248, 10 };
+	data.setCandidatePool(325);
+	EXPECT_TRUE(ref == data.process(0, 10, EMRMRMethod::MID));
+	EXPECT_EQ(stats.poolRounds(), 0u);
+
+	// Only the pool is scanned, the selection is the same when the boundary never matters
+	for (const size_t size : { 20, 100 })
+	{
+		stats.reset();
+		data.setCandidatePool(size);
+		const std::vector<size_t> calc = data.process(0, 10, EMRMRMethod::MID);
+		EXPECT_EQ(calc.size(), 10u);
+		EXPECT_EQ(stats.poolRounds(), 10u);
+		EXPECT_EQ(stats.redundancyCalls(), 9 * size - 45);	// (size - 1) + ... + (size - 9)
+		if (size == 20) { EXPECT_GT(stats.boundaryRiskRounds(), 0u); }
+		else
+		{
+			EXPECT_EQ(stats.boundaryRiskRounds(), 0u);
+			EXPECT_TRUE(ref == calc) << ErrorMsg("Pool of " + std::to_string(size), ref, calc).str();
+		}
+	}
+	data.setCandidatePool(5);
+	EXPECT_EQ(data.process(0, 10, EMRMRMethod::MID).size(), 5u);
+
+	// Prescreen on a part of the samples
+	stats.reset();
+	data.setCandidatePool(100, 40);
+	EXPECT_EQ(data.process(0, 10, EMRMRMethod::MID).size(), 10u);
+	EXPECT_EQ(stats.relevanceCalls(), 325u + 100u);
+	data.setCandidatePool(100, 73);	// All samples, no prescreen
+	EXPECT_TRUE(ref == data.process(0, 10, EMRMRMethod::MID));
+
+	// Sparse datas (all values in CSC format), the prescreen is ignored
+	std::vector<std::vector<double>> rows;
+	std::vector<int> classes;
+	readRows(rows, classes);
+	ASSERT_EQ(rows.size(), 73u);
+	std::vector<size_t> offsets(1, 0), samples;
+	std::vector<double> values;
+	for (size_t j = 0; j < rows[0].size(); ++j)
+	{
+		for (size_t i = 0; i < rows.size(); ++i)
+		{
+			samples.push_back(i);
+			values.push_back(rows[i][j]);
+		}
+		offsets.push_back(samples.size());
+	}
+	CMRMR sparse;
+	EXPECT_TRUE(sparse.setSparseDatas(ESparseFormat::CSC, rows[0].size(), offsets, samples, values, classes));
+	sparse.setCandidatePool(100, 40);
+	data.setCandidatePool(100);
+	const std::vector<size_t> pooled = data.process(0, 10, EMRMRMethod::MID), calc = sparse.process(0, 10, EMRMRMethod::MID);
+	EXPECT_TRUE(pooled == calc) << ErrorMsg("Sparse pool with prescreen", pooled, calc).str();
+}
+
+TEST_F(Test_mRMRM, binaryFile)
+{
+	const std::string raw = "test_raw.bin", coded = "test_coded.bin";
+	EXPECT_TRUE(m_data.save(raw));
+	m_data.process(0, 10, EMRMRMethod::MID);
+	EXPECT_TRUE(m_data.save(coded));
+
+	CMRMR data;
+	EXPECT_TRUE(data.load(raw));
+	EXPECT_EQ(data.print(), "Datas contain 325 Features, with 73 samples, for 7 Classes (Class 0 : id(1), 6 samples, Class 1 : id(2), 5 samples, "
+							"Class 2 : id(3), 5 samples, Class 3 : id(4), 16 samples, Class 4 : id(5), 7 samples, Class 5 : id(6), 13 samples, "
+							"Class 6 : id(7), 21 samples).\nDatas are not z-scored and discretize.\n");
+	std::vector<size_t> calc = data.process(std::numeric_limits<double>::infinity(), 10, EMRMRMethod::MIQ);
+	std::vector<size_t> ref  = { 22, 139, 274, 104, 234, 33, 145, 105, 261, 41 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Binary file without codes, no discretization, nFeatures = 10, method = MIQ", ref, calc).str();
+
+	EXPECT_TRUE(data.load(coded));
+	EXPECT_EQ(m_data.print(), data.print());
+	calc = data.process(0, 10, EMRMRMethod::MIQ);
+	ref  = { 230, 139, 140, 6, 304, 234, 276, 261, 145, 142 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Binary file with codes, threshold = 0, nFeatures = 10, method = MIQ", ref, calc).str();
+
+	// Copy on write
+	CMRMR copy = data;
+	EXPECT_TRUE(data.addSample(std::vector<double>(325, 0.0), 1));
+	EXPECT_EQ(copy.print(), m_data.print());
+	calc = copy.process(0, 10, EMRMRMethod::MIQ);
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Copy of binary file with codes, threshold = 0, nFeatures = 10, method = MIQ", ref, calc).str();
+
+	testing::internal::CaptureStderr();
+	EXPECT_FALSE(data.load(FILENAME));
+	EXPECT_EQ(testing::internal::GetCapturedStderr(), "Not a mRMR binary file (or not the same endianness).\n");
+
+	// Corrupted files : a section on the next one, a feature with codes out of its states (offsets of the sections at 48, 56, 64 and 72)
+	const std::string corrupted = "test_corrupted.bin";
+	std::ifstream in(coded, std::ios::binary);
+	const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	const auto corrupt = [&](const size_t offset, const uint64_t value)
+	{
+		std::vector<char> copy = bytes;
+		std::memcpy(copy.data() + offset, &value, sizeof(uint64_t));
+		std::ofstream(corrupted, std::ios::binary).write(copy.data(), std::streamsize(copy.size()));
+	};
+	uint64_t datas, states;
+	std::memcpy(&datas, bytes.data() + 56, sizeof(uint64_t));
+	std::memcpy(&states, bytes.data() + 64, sizeof(uint64_t));
+	testing::internal::CaptureStderr();
+	corrupt(64, datas);
+	EXPECT_FALSE(data.load(corrupted));
+	corrupt(size_t(states), 1);
+	EXPECT_FALSE(data.load(corrupted));
+	corrupt(size_t(states), 300);
+	EXPECT_FALSE(data.load(corrupted));
+	testing::internal::GetCapturedStderr();
+	std::remove(corrupted.c_str());
+	std::remove(raw.c_str());
+	std::remove(coded.c_str());
+}
+
+TEST(Test_mRMR, mutualInfosFile)
+{
+	const std::string square = "test_infos.bin", triangle = "test_infos_float.bin", top = "test_infos_top.bin";
+	CMRMR writer;
+	EXPECT_TRUE(writer.readCSV(FILENAME));
+	EXPECT_TRUE(writer.saveMutualInfos(square, 0, EPrecision::Double, 0, 4));
+	EXPECT_TRUE(writer.saveMutualInfos(triangle, 0, EPrecision::Float));
+	EXPECT_TRUE(writer.saveMutualInfos(top, 0, EPrecision::Double, 50, 4));
+	const std::vector<size_t> refMID = writer.process(0, 10, EMRMRMethod::MID), refMIQ = writer.process(0, 10, EMRMRMethod::MIQ);
+
+	// All mutual infos are looked up in the file
+	CMRMR data;
+	CMRMRStats stats;
+	data.setStats(&stats);
+	EXPECT_TRUE(data.readCSV(FILENAME));
+	EXPECT_TRUE(data.loadMutualInfos(square));
+	stats.reset();
+	EXPECT_TRUE(refMID == data.process(0, 10, EMRMRMethod::MID));
+	EXPECT_TRUE(refMIQ == data.process(0, 10, EMRMRMethod::MIQ));
+	EXPECT_EQ(stats.cachedCalls(), stats.relevanceCalls() + stats.redundancyCalls());
+	EXPECT_TRUE(data.loadMutualInfos(triangle));
+	EXPECT_EQ(data.process(0, 10, EMRMRMethod::MID).size(), 10u);
+
+	// Only the top features, the others are computed
+	EXPECT_TRUE(data.loadMutualInfos(top));
+	stats.reset();
+	EXPECT_TRUE(refMID == data.process(0, 10, EMRMRMethod::MID));
+	EXPECT_GT(stats.cachedCalls(), 325u);
+	EXPECT_LT(stats.cachedCalls(), stats.relevanceCalls() + stats.redundancyCalls());
+
+	// Other codes, the file isn't used
+	stats.reset();
+	data.process(std::numeric_limits<double>::infinity(), 10, EMRMRMethod::MID);
+	EXPECT_EQ(stats.cachedCalls(), 0u);
+
+	testing::internal::CaptureStderr();
+	EXPECT_FALSE(data.loadMutualInfos(FILENAME));
+	CMRMR other;
+	EXPECT_TRUE(other.setDatas({ { 1, 2 }, { 3, 4 } }, { 1, 2 }));
+	EXPECT_FALSE(other.loadMutualInfos(square));
+
+	// Corrupted header : the relevances are moved on the mutual infos (offsets of the sections at 56, 64 and 72)
+	const std::string corrupted = "test_infos_corrupted.bin";
+	{
+		std::ifstream in(square, std::ios::binary);
+		std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		std::memcpy(bytes.data() + 56, bytes.data() + 72, sizeof(uint64_t));
+		std::ofstream(corrupted, std::ios::binary).write(bytes.data(), std::streamsize(bytes.size()));
+	}
+	EXPECT_FALSE(data.loadMutualInfos(corrupted));
+	testing::internal::GetCapturedStderr();
+	for (const auto& f : { square, triangle, top, corrupted }) { std::remove(f.c_str()); }
+}
+
+TEST(Test_mRMR, streamCSV)
+{
+	const std::string scratch = "test_scratch.bin";
+	CMRMR data;
+	EXPECT_TRUE(data.streamCSV(FILENAME, 0, scratch, 2));
+	std::vector<size_t> calc = data.process(0, 10, EMRMRMethod::MIQ);
+	std::vector<size_t> ref  = { 230, 139, 140, 6, 304, 234, 276, 261, 145, 142 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Stream CSV, threshold = 0, nFeatures = 10, method = MIQ", ref, calc).str();
+
+	// Only the streamed threshold is available
+	testing::internal::CaptureStderr();
+	EXPECT_TRUE(data.process(1, 10, EMRMRMethod::MID).empty());
+	EXPECT_FALSE(testing::internal::GetCapturedStderr().empty());
+
+	EXPECT_TRUE(data.streamCSV(FILENAME, 1, scratch));
+	calc = data.process(1, 10, EMRMRMethod::MID);
+	ref  = { 22, 125, 243, 132, 242, 29, 150, 166, 18, 269 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Stream CSV, threshold = 1, nFeatures = 10, method = MID", ref, calc).str();
+
+	EXPECT_TRUE(data.streamCSV(FILENAME, std::numeric_limits<double>::infinity(), scratch));
+	calc = data.process(std::numeric_limits<double>::infinity(), 10, EMRMRMethod::MIQ);
+	ref  = { 22, 139, 274, 104, 234, 33, 145, 105, 261, 41 };
+	EXPECT_TRUE(ref == calc) << ErrorMsg("Stream CSV, no discretization, nFeatures = 10, method = MIQ", ref, calc).str();
+
+	// The scratch file is removed with the datas
+	data.reset();
+	EXPECT_FALSE(std::ifstream(scratch).good());
+}
+
+TEST(Test_MutualInfo, bitPlanes)
+{
+	const size_t n = 1000, n1 = 3, n2 = 7, words = MutualInfo::nWords(n);
+	std::mt19937 gen(42);
+	std::vector<uint8_t> v1(n), v2(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		v1[i] = uint8_t(gen() % n1);
+		v2[i] = uint8_t((v1[i] + gen() % 3) % n2);	// Some dependence
+	}
+	std::vector<uint64_t> p1(n1 * words, 0), p2(n2 * words, 0);
+	std::vector<size_t> c1(n1), c2(n2);
+	MutualInfo::buildBitPlanes(v1.data(), n1, n, p1.data(), c1.data());
+	MutualInfo::buildBitPlanes(v2.data(), n2, n, p2.data(), c2.data());
+
+	EXPECT_EQ(MutualInfo::generic(v1.data(), n1, v2.data(), n2, n), MutualInfo::bitPlanes(p1.data(), c1.data(), n1, p2.data(), c2.data(), n2, n));
+	EXPECT_EQ(MutualInfo::generic(v2.data(), n2, v1.data(), n1, n), MutualInfo::bitPlanes(p2.data(), c2.data(), n2, p1.data(), c1.data(), n1, n));
+	EXPECT_EQ(MutualInfo::generic(v1.data(), n1, v1.data(), n1, n), MutualInfo::bitPlanes(p1.data(), c1.data(), n1, p1.data(), c1.data(), n1, n));
+}
+
+TEST(Test_MutualInfo, workspace)
+{
+	// Specialized (3 x n) and generic tables with a reused workspace, compared with a direct computation
+	std::mt19937 gen(3);
+	MutualInfo::SWorkspace ws;
+	for (const auto& states : std::vector<std::pair<size_t, size_t>>{ { 3, 4 }, { 5, 3 }, { 3, 3 }, { 12, 3 }, { 2, 9 }, { 3, 2 } })
+	{
+		const size_t n1 = states.first, n2 = states.second, n = 500;
+		std::vector<uint8_t> v1(n), v2(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			v1[i] = uint8_t(gen() % n1);
+			v2[i] = uint8_t((v1[i] + gen() % 2) % n2);
+		}
+		double ref = 0;
+		for (size_t a = 0; a < n1; ++a)
+		{
+			for (size_t b = 0; b < n2; ++b)
+			{
+				double pab = 0, pa = 0, pb = 0;
+				for (size_t i = 0; i < n; ++i)
+				{
+					pab += (v1[i] == a && v2[i] == b) ? 1.0 / n : 0.0;
+					pa += (v1[i] == a) ? 1.0 / n : 0.0;
+					pb += (v2[i] == b) ? 1.0 / n : 0.0;
+				}
+				if (pab > 0) { ref += pab * std::log2(pab / (pa * pb)); }
+			}
+		}
+		MutualInfo::genericCounts(v1.data(), n1, v2.data(), n2, n, ws.counts);
+		const double calc = MutualInfo::fromCounts(ws, n1, n2, n);
+		EXPECT_NEAR(ref, calc, 1e-12);
+		EXPECT_EQ(MutualInfo::generic(v1.data(), n1, v2.data(), n2, n), calc);
+	}
+
+	// Independent variables (product of the marginals), the rounding gives -1.9e-16 without clamp
+	std::vector<double> counts = { 1, 5, 2, 10 };
+	EXPECT_EQ(MutualInfo::fromCounts(counts, 2, 2, 18), 0.0);
+}